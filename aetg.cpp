@@ -0,0 +1,149 @@
+#include "aetg.h"
+
+using namespace std;
+
+/**
+ *
+ *	This function builds the suite for a model with the
+ *  AETG engine for its strength: the bit-packed pair grid
+ *  for strength 2 and the t-way tuple engine above that.
+ *
+ *	Returns the caller's suite, holding the selected test suite.
+ *
+ */
+TestSuite& AetgEngine::generate(Model& model, GenerationOptions& options, ThreadPool& pool, TestSuite& suite, SuiteStats& stats)
+{
+	if (model.strength == 2)
+	{
+		return selectSuite(model.levels, model.constraints, options, pool, pairWorkspaces, suite, stats);
+	}
+	return selectSuiteTWay(model.levels, model.strength, model.constraints, options, pool, tupleWorkspaces, suite, stats);
+}
+
+/**
+ *
+ *	This function builds the pairwise suite for a model
+ *  with IPOG.
+ *
+ *	Returns the caller's suite, holding the generated test suite.
+ *
+ */
+TestSuite& IpogEngine::generate(Model& model, GenerationOptions& options, ThreadPool& pool, TestSuite& suite, SuiteStats& stats)
+{
+	return selectSuiteIPOG(model.levels, model.constraints, options, pool, workspace, topUpWorkspaces, suite, stats);
+}
+
+/**
+ *
+ *	This function builds the pairwise suite for a model
+ *  from a construction.
+ *
+ *	Returns the caller's suite, holding the constructed test suite.
+ *
+ */
+TestSuite& ConstructEngine::generate(Model& model, GenerationOptions& options, ThreadPool& pool, TestSuite& suite, SuiteStats& stats)
+{
+	return selectSuiteConstructed(model.levels, model.constraints, options, pool, fillWorkspaces, rows, suite, stats);
+}
+
+/**
+ *
+ *	This function looks up one of the generator's engines
+ *  by name, for callers that check a name before they
+ *  generate.
+ *
+ *	Returns the engine, or NULL if no engine has the name.
+ *
+ */
+Engine* Generator::engine(const string& name)
+{
+	if (name == aetg.name())
+	{
+		return &aetg;
+	}
+	if (name == ipog.name())
+	{
+		return &ipog;
+	}
+	if (name == construct.name())
+	{
+		return &construct;
+	}
+	return NULL;
+}
+
+/**
+ *
+ *	This function picks the engine named in the options,
+ *  falling back to AETG when the name is unknown or the
+ *  engine can not build the model. With no name, the
+ *  construction engine is picked for the models its suite
+ *  is optimal for (see constructionOptimal()), and AETG
+ *  for the rest, since the product constructions are often
+ *  larger than the AETG suite.
+ *
+ *	Returns the engine that builds the suite.
+ *
+ */
+Engine& Generator::engineFor(const Model& model, const GenerationOptions& options)
+{
+	if (options.engine == NULL)
+	{
+		return construct.optimalFor(model, options) ? (Engine&)construct : (Engine&)aetg;
+	}
+	Engine* named = engine(options.engine);
+	if (named == NULL || !named->supports(model, options))
+	{
+		return aetg;
+	}
+	return *named;
+}
+
+/**
+ *
+ *	This function builds the suite for a model with the
+ *  engine picked by engineFor(). The caller's suite is
+ *  overwritten, and keeps its storage from one call to the
+ *  next.
+ *
+ *	Returns the caller's suite, holding the selected test suite.
+ *
+ */
+TestSuite& Generator::generate(Model& model, GenerationOptions& options, TestSuite& suite, SuiteStats& stats)
+{
+	return engineFor(model, options).generate(model, options, pool, suite, stats);
+}
+
+/**
+ *
+ *	This function builds the suite for a model and copies
+ *  it row by row into memory owned by the caller, one int
+ *  (the component number) per factor. At most maxRows test
+ *  cases are copied, so a caller that does not know the
+ *  size in advance can pass a small buffer, read the size
+ *  and call again with the same seed for the same suite.
+ *
+ *	Returns the number of test cases in the whole suite.
+ *
+ */
+int Generator::generate(Model& model, GenerationOptions& options, int* rows, int maxRows, SuiteStats& stats)
+{
+	generate(model, options, rowSuite, stats);
+	rowSuite.copyRows(rows, maxRows);
+	return rowSuite.size();
+}
+
+/**
+ *
+ *	This function checks the coverage of a suite file
+ *  against a model with the generator's thread pool, so a
+ *  program that generates and checks suites starts only
+ *  one set of threads.
+ *
+ *	Returns true if the suite was read without errors, otherwise sets error.
+ *
+ */
+bool Generator::verify(const string& fileName, Model& model, bool namedLevels, bool countTuples, CoverageReport& report, string& error)
+{
+	return verifySuiteFile(fileName, model, namedLevels, pool, countTuples, report, error);
+}
\ No newline at end of file
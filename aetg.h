@@ -0,0 +1,178 @@
+#pragma once
+#include "aetgfunctions.h"
+#include "suitefile.h"
+
+/**
+ *
+ *  This class is the interface of a suite building
+ *  engine. An engine turns a model into a suite the way
+ *  selectSuite() does: it fills the caller's suite and
+ *  stats, honours the reduce, progress and sink settings of
+ *  the options, and keeps whatever it allocates for the
+ *  next model. Engines share the coverage grid, the suite
+ *  storage and the output code, so they differ only in how
+ *  rows are chosen.
+ *
+ */
+class Engine
+{
+public:
+	virtual ~Engine()
+	{
+	}
+
+	//returns the name the engine is picked by
+	virtual const char* name() const = 0;
+
+	//returns true if the engine can build a suite for the model with the options
+	virtual bool supports(const Model& model, const GenerationOptions& options) const = 0;
+
+	//builds the suite for a model into the caller's suite and returns it
+	virtual TestSuite& generate(Model& model, GenerationOptions& options, ThreadPool& pool, TestSuite& suite, SuiteStats& stats) = 0;
+};
+
+/**
+ *
+ *  This class is the random greedy AETG engine: many
+ *  suites built from candidate test cases, the smallest
+ *  kept. It handles every model, with the bit-packed pair
+ *  grid for strength 2 and the t-way tuple engine above
+ *  that.
+ *
+ */
+class AetgEngine : public Engine
+{
+private:
+	std::vector<SuiteWorkspace> pairWorkspaces;
+	std::vector<TupleWorkspace> tupleWorkspaces;
+public:
+	const char* name() const
+	{
+		return "aetg";
+	}
+
+	bool supports(const Model&, const GenerationOptions&) const
+	{
+		return true;
+	}
+
+	TestSuite& generate(Model& model, GenerationOptions& options, ThreadPool& pool, TestSuite& suite, SuiteStats& stats);
+};
+
+/**
+ *
+ *  This class is the deterministic IPOG engine, see
+ *  selectSuiteIPOG(). It builds pairwise suites and can
+ *  not start from seed rows, since it places the factors in
+ *  its own order.
+ *
+ */
+class IpogEngine : public Engine
+{
+private:
+	IpogWorkspace workspace;
+	std::vector<SuiteWorkspace> topUpWorkspaces;
+public:
+	const char* name() const
+	{
+		return "ipog";
+	}
+
+	bool supports(const Model& model, const GenerationOptions& options) const
+	{
+		return model.strength == 2 && options.seedRows == NULL;
+	}
+
+	TestSuite& generate(Model& model, GenerationOptions& options, ThreadPool& pool, TestSuite& suite, SuiteStats& stats);
+};
+
+/**
+ *
+ *  This class builds pairwise suites from known
+ *  constructions (orthogonal arrays over GF(q), their
+ *  products, and the optimal two-level arrays), see
+ *  selectSuiteConstructed(). It takes unconstrained models
+ *  that constructionApplies() accepts, with no seed rows.
+ *
+ */
+class ConstructEngine : public Engine
+{
+private:
+	std::vector<SuiteWorkspace> fillWorkspaces;
+	std::vector<TestCase> rows;
+public:
+	const char* name() const
+	{
+		return "construct";
+	}
+
+	bool supports(const Model& model, const GenerationOptions& options) const
+	{
+		return model.strength == 2 && model.constraints.empty() && options.seedRows == NULL && constructionApplies(model.levels);
+	}
+
+	//true if the engine builds the model and its suite is optimal, which is when it is picked without being named
+	bool optimalFor(const Model& model, const GenerationOptions& options) const
+	{
+		return supports(model, options) && constructionOptimal(model.levels);
+	}
+
+	TestSuite& generate(Model& model, GenerationOptions& options, ThreadPool& pool, TestSuite& suite, SuiteStats& stats);
+};
+
+/**
+ *
+ *  This class is the entry point for programs that embed
+ *  the generator as a library (libaetg). A model goes in
+ *  and a suite comes out, either in a TestSuite owned by
+ *  the caller or copied into a block of memory the caller
+ *  provides. Nothing is printed and no file is touched;
+ *  progress is reported through the callback in the
+ *  options, and input errors from the loaders come back as
+ *  strings. The thread pool and the engines' workspaces
+ *  live as long as the generator, so generating many
+ *  models with one generator does not allocate again once
+ *  the largest model has been built.
+ *
+ *  The engine named in the options builds the suite. A
+ *  model the engine does not support (IPOG given a strength
+ *  above 2, or seed rows) is built by AETG instead. With no
+ *  engine named, a model with a known construction is
+ *  built from it and any other model by AETG.
+ *
+ */
+class Generator
+{
+private:
+	ThreadPool pool;
+	AetgEngine aetg;
+	IpogEngine ipog;
+	ConstructEngine construct;
+	TestSuite rowSuite;
+public:
+	//creates a generator that runs on the given number of threads (0 picks one per hardware thread)
+	Generator(int threads = 0) : pool(threads)
+	{
+	}
+
+	//returns how many threads generate suites at once
+	int threads() const
+	{
+		return pool.slots();
+	}
+
+	//returns the engine with the given name, or NULL if there is none
+	Engine* engine(const std::string& name);
+
+	//returns the engine that builds the suite for a model with the options
+	Engine& engineFor(const Model& model, const GenerationOptions& options);
+
+	//builds the suite for a model into the caller's suite and returns it
+	TestSuite& generate(Model& model, GenerationOptions& options, TestSuite& suite, SuiteStats& stats);
+
+	//builds the suite for a model and copies up to maxRows test cases (factors ints each) into rows
+	int generate(Model& model, GenerationOptions& options, int* rows, int maxRows, SuiteStats& stats);
+
+	//checks the coverage of a suite file against a model on the generator's threads, see verifySuiteFile()
+	bool verify(const std::string& fileName, Model& model, bool namedLevels, bool countTuples, CoverageReport& report, std::string& error);
+};
\ No newline at end of file
@@ -1,21 +1,80 @@
 #pragma once
 #include "aetgstructs.h"
+#include "threadpool.h"
+#include "profile.h"
+#include <string>
+
+class Generator;
 
 //definitions found in grid.cpp
 void inputFactorLevels(std::vector<int>& factorLevels);
 int countComponents(std::vector<int>& levels);
-std::vector<std::vector<int>> componentGrid(int factors, std::vector<int>& levels, int totalComponents);
-void printGrid(std::vector<std::vector<int>> &grid);
+void printGrid(CoverageGrid& grid);
 std::vector<int> initializeUncovered(std::vector<int>& levels, int totalComponents);
 std::vector<int> factorStartingNums(std::vector<int>& levels);
 
-//definitions found in testcases.cpp
-TestCase firstTestGenerator(int factors, std::vector<int>& levels, std::vector<std::vector<int>>& grid);
-TestCase testGenerator(int factors, std::vector<int>& levels, std::vector<int>& pairsRemaining, std::vector<int>& factorBegin, int totalComponents, std::vector<std::vector<int>>& grid);
-void factorShuffle(std::vector<int>& factorOrder);
-void countNewPairs(TestCase& currentTestCase, std::vector<std::vector<int>>& grid);
-TestCase selectCandidate(int factors, std::vector<int>& levels, std::vector<int>& pairsRemaining, std::vector<int>& factorBegin, int totalComponents, std::vector<std::vector<int>>& grid);
-void addToSuite(TestCase currentTestCase, std::vector<std::vector<int>>& grid, std::vector<int>& pairsRemaining);
-std::vector<TestCase> selectSuite(std::vector<int>& factorLevels);
-void outputSuiteFile(std::vector<TestCase>& selectedSuite);
-void outputSuiteAnalytics(std::vector<TestCase>& selectedSuite, unsigned int smallestSuiteSize, unsigned int largestSuiteSize, int totalCases);
\ No newline at end of file
+//definitions found in testcases.cpp, the pair generator is templated on the test case cell type and the grid's row width (0 if only known at run time)
+template <typename Index, int RowWords> void firstTestGenerator(BasicTestCase<Index>& firstCase, int factors, std::vector<int>& levels, CoverageGrid& grid, RandomStream& rng, CandidateScratch& scratch);
+template <typename Index, int RowWords> void testGenerator(BasicTestCase<Index>& testCase, int factors, std::vector<int>& levels, UncoveredCounts& pairsRemaining, std::vector<int>& factorBegin, CoverageGrid& grid, PairWorklist& worklist, ConstraintSet& constraints, RandomStream& rng, CandidateScratch& scratch);
+template <typename Index, int RowWords> bool completeTestCase(BasicTestCase<Index>& testCase, std::vector<int>& levels, std::vector<int>& factorBegin, CoverageGrid& grid, PairWorklist& worklist, ConstraintSet& constraints, RandomStream& rng, CandidateScratch& scratch);
+template <typename Index, int RowWords> bool buildAroundPair(BasicTestCase<Index>& testCase, std::vector<int>& levels, UncoveredCounts& pairsRemaining, std::vector<int>& factorBegin, CoverageGrid& grid, PairWorklist& worklist, ConstraintSet& constraints, RandomStream& rng, CandidateScratch& scratch, int& uncoverablePairs);
+void factorShuffle(std::vector<int>& factorOrder, RandomStream& rng);
+template <typename Index, int RowWords> void countNewPairs(BasicTestCase<Index>& currentTestCase, CoverageGrid& grid);
+template <typename Index, int RowWords> BasicTestCase<Index>& selectCandidate(std::vector<BasicTestCase<Index>>& generated, std::vector<CandidateScratch>& scratch, int candidates, int factors, std::vector<int>& levels, UncoveredCounts& pairsRemaining, std::vector<int>& factorBegin, int totalComponents, CoverageGrid& grid, PairWorklist& worklist, ConstraintSet& constraints, RandomStream& rng, ThreadPool& pool);
+template <typename Index> BasicTestCase<Index>& pickCandidate(std::vector<BasicTestCase<Index>>& generated, int count, RandomStream& rng);
+template <typename Index, int RowWords> void addToSuite(const BasicTestCase<Index>& currentTestCase, CoverageGrid& grid, UncoveredCounts& pairsRemaining);
+TestSuite& selectSuite(std::vector<int>& factorLevels, ConstraintSet& constraints, GenerationOptions& options, ThreadPool& pool, std::vector<SuiteWorkspace>& workspaces, TestSuite& selectedSuite, SuiteStats& stats);
+void finishSuite(TestSuite& selectedSuite, std::vector<int>& factorLevels, ConstraintSet& constraints, GenerationOptions& options, ThreadPool& pool, SuiteStats& stats);
+void writeToStream(const char* data, size_t size, void* stream);
+void outputSuiteFile(TestSuite& selectedSuite);
+void outputSuiteAnalytics(TestSuite& selectedSuite, SuiteStats& stats, ConstraintSet& constraints, int strength, bool streamed);
+
+//definitions found in tway.cpp
+std::vector<int> initializeUncoveredTuples(std::vector<int>& levels, int strength);
+void testGeneratorTWay(TestCase& testCase, std::vector<int>& levels, std::vector<int>& factorBegin, TupleCoverage& coverage, UncoveredCounts& tuplesRemaining, ConstraintSet& constraints, RandomStream& rng, CandidateScratch& scratch);
+bool completeTestCaseTWay(TestCase& testCase, std::vector<int>& levels, std::vector<int>& factorBegin, TupleCoverage& coverage, UncoveredCounts& tuplesRemaining, ConstraintSet& constraints, RandomStream& rng, CandidateScratch& scratch);
+TestCase& selectCandidateTWay(std::vector<TestCase>& generated, std::vector<CandidateScratch>& scratch, int candidates, std::vector<int>& levels, std::vector<int>& factorBegin, TupleCoverage& coverage, UncoveredCounts& tuplesRemaining, ConstraintSet& constraints, RandomStream& rng, ThreadPool& pool);
+void addToSuiteTWay(const TestCase& currentTestCase, std::vector<int>& factorBegin, TupleCoverage& coverage, UncoveredCounts& tuplesRemaining);
+void excludeForbiddenTuples(TupleCoverage& coverage, std::vector<int>& startingCounts, std::vector<int>& factorBegin, ConstraintSet& constraints);
+bool buildAroundTuple(TestCase& testCase, std::vector<int>& levels, std::vector<int>& factorBegin, TupleCoverage& coverage, UncoveredCounts& tuplesRemaining, ConstraintSet& constraints, RandomStream& rng, CandidateScratch& scratch, int& uncoverableTuples);
+TestSuite& selectSuiteTWay(std::vector<int>& factorLevels, int strength, ConstraintSet& constraints, GenerationOptions& options, ThreadPool& pool, std::vector<TupleWorkspace>& workspaces, TestSuite& selectedSuite, SuiteStats& stats);
+
+//definitions found in ipog.cpp
+TestSuite& selectSuiteIPOG(std::vector<int>& factorLevels, ConstraintSet& constraints, GenerationOptions& options, ThreadPool& pool, IpogWorkspace& workspace, std::vector<SuiteWorkspace>& topUpWorkspaces, TestSuite& selectedSuite, SuiteStats& stats);
+
+//definitions found in construct.cpp
+bool constructionApplies(const std::vector<int>& levels);
+bool constructionOptimal(const std::vector<int>& levels);
+int constructRows(std::vector<int>& levels, std::vector<TestCase>& rows);
+TestSuite& selectSuiteConstructed(std::vector<int>& factorLevels, ConstraintSet& constraints, GenerationOptions& options, ThreadPool& pool, std::vector<SuiteWorkspace>& fillWorkspaces, std::vector<TestCase>& rows, TestSuite& selectedSuite, SuiteStats& stats);
+
+//definitions found in reduce.cpp
+int reduceSuite(TestSuite& suite, std::vector<int>& levels, int strength, ConstraintSet& constraints, int fixedRows);
+
+//definitions found in shrink.cpp
+int shrinkSuite(TestSuite& suite, std::vector<int>& levels, ConstraintSet& constraints, ThreadPool& pool, uint64_t seed, double seconds, int fixedRows);
+
+//definitions found in constraints.cpp
+bool loadConstraints(const std::string& fileName, std::vector<int>& levels, ConstraintSet& constraints, std::string& error);
+bool applyConstraint(const std::string& keyword, const std::vector<int>& combination, ConstraintSet& constraints);
+
+//definitions found in model.cpp
+bool loadModel(const std::string& fileName, Model& model, int defaultStrength, std::string& error);
+bool listModels(const std::string& path, std::vector<std::string>& modelFiles, std::string& error);
+bool outputModelSuite(TestSuite& selectedSuite, Model& model, const std::string& fileName);
+bool loadSuiteRows(const std::string& fileName, Model& model, std::vector<TestCase>& rows, std::string& error);
+bool runBatch(const std::string& batchPath, const std::string& outputDirectory, int defaultStrength, GenerationOptions& options, Generator& generator);
+
+//definitions found in suitefile.cpp
+bool outputSuiteBinary(TestSuite& selectedSuite, std::vector<int>& levels, const std::string& fileName);
+bool isSuiteFile(const std::string& fileName);
+
+//definitions found in verify.cpp
+bool verifyRows(RowSource source, void* sourceData, std::vector<int>& levels, int strength, ConstraintSet& constraints, ThreadPool& pool, bool countTuples, CoverageReport& report);
+bool verifySuiteFile(const std::string& fileName, Model& model, bool namedLevels, ThreadPool& pool, bool countTuples, CoverageReport& report, std::string& error);
+bool outputCoverageReport(CoverageReport& report, Model& model, const std::string& reportFile);
+
+//definitions found in scoring.cpp
+void scoreLevels(const uint64_t* rows, int levels, int rowWords, const uint64_t* selected, int* scores);
+const char* scoringKernelName();
+bool setScoringKernel(const char* name);
\ No newline at end of file
@@ -1,43 +1,87 @@
 #pragma once
 #include <iostream>
 #include <vector>
+#include <string>
+#include <cstdint>
+#include <algorithm>
+#include <chrono>
+#include <atomic>
+#include <type_traits>
 
 /**
  *
  *  This data structure holds all selected components for each
  *  instance and maintains a count of how many new pairs are
  *	covered by the case.
+ *
+ *  Each cell is an Index. Signed cells hold the component
+ *  number itself and -1 for a factor without a component,
+ *  unsigned cells hold the component number plus one and 0,
+ *  so reading a cell never needs a check. The pairwise
+ *  generator picks the narrowest type the model's component
+ *  numbers fit (see selectSuite()), everything else uses
+ *  TestCase, the int form.
  *		
  */
-class TestCase
+template <typename Index>
+class BasicTestCase
 {
 private:
-	std::vector<int> testComponents;
+	std::vector<Index> testComponents;
 	int newPairs;
 public:
+	//what a cell holds on top of its component number, and the cell value of a factor without a component
+	static const int bias = std::is_signed<Index>::value ? 0 : 1;
+	static const Index unset = (Index)(bias - 1);
+
+	//constructor to create an empty test case, call reset() before use
+	BasicTestCase()
+	{
+		newPairs = 0;
+	}
+
 	//constructor to create vector of components based on number of factors
-	TestCase(int factors)
+	BasicTestCase(int factors)
+	{
+		testComponents = std::vector<Index>(factors, unset);
+		newPairs = 0;
+	}
+
+	//clears the test case for reuse, keeping its storage so no allocation is needed
+	void reset(int factors)
 	{
-		testComponents = std::vector<int>(factors, -1);
+		testComponents.assign(factors, unset);
 		newPairs = 0;
 	}
+
+	//copies a test case held in another cell type, keeping this one's storage
+	template <typename Other>
+	void assign(const BasicTestCase<Other>& other)
+	{
+		testComponents.resize(other.testSize());
+		for (int f = 0; f != other.testSize(); f++)
+		{
+			testComponents[f] = (Index)(other.atIndex(f) + bias);
+		}
+		newPairs = other.newPairsCount();
+	}
 	
 	//returns current number of new pairs covered by the test case
-	int newPairsCount()
+	int newPairsCount() const
 	{
 		return newPairs;
 	}
 
 	//returns how many factors are included in the test case
-	int testSize()
+	int testSize() const
 	{
 		return testComponents.size();
 	}
 
-	//returns which component is selected for a given factor (index)
-	int atIndex(int index)
+	//returns which component is selected for a given factor (index), -1 if none is
+	int atIndex(int index) const
 	{
-		return testComponents[index];
+		return (int)testComponents[index] - bias;
 	}
 
 	//sets number of new pairs for the case directly
@@ -61,21 +105,1830 @@ public:
 	//places a selected component into the test case at the correct factor's index
 	void setComponent(int factor, int componentNumber)
 	{
-		testComponents[factor] = componentNumber;
+		testComponents[factor] = (Index)(componentNumber + bias);
 	}
 
-	std::vector<int> getTest()
+	//returns the cells without copying them, each holding its component number plus bias
+	const std::vector<Index>& getTest() const
 	{
 		return testComponents;
 	}
 
 	//print all of the components in a test case on a single line
-	void printTestCase()
+	void printTestCase() const
 	{
 		for (int i = 0; i != testComponents.size(); i++)
 		{
-			std::cout << testComponents[i] << " ";
+			std::cout << atIndex(i) << " ";
+		}
+		std::cout << std::endl;
+	}
+};
+
+template <typename Index>
+const int BasicTestCase<Index>::bias;
+
+template <typename Index>
+const Index BasicTestCase<Index>::unset;
+
+typedef BasicTestCase<int> TestCase;
+
+/**
+ *
+ *  This data structure holds a whole test suite as one
+ *  contiguous row-major matrix of component numbers. Each
+ *  cell uses the smallest unsigned type that can hold every
+ *  component number of the model (1, 2 or 4 bytes), and the
+ *  storage is kept when the suite is cleared, so a suite
+ *  that is rebuilt over and over stops allocating once it
+ *  has reached its largest size.
+ *
+ */
+class TestSuite
+{
+private:
+	std::vector<unsigned char> cells;
+	int factorCount;
+	int width;
+	int rows;
+public:
+	TestSuite()
+	{
+		factorCount = 0;
+		width = 1;
+		rows = 0;
+	}
+
+	//removes all rows and picks the cell width for a model, keeping the storage
+	void reset(int factors, int totalComponents)
+	{
+		factorCount = factors;
+		width = totalComponents <= 0x100 ? 1 : (totalComponents <= 0x10000 ? 2 : 4);
+		rows = 0;
+		cells.clear();
+	}
+
+	//appends a complete test case as a new row
+	template <typename Index>
+	void appendRow(const BasicTestCase<Index>& testCase)
+	{
+		cells.resize(cells.size() + (size_t)factorCount * width);
+		rows++;
+		for (int f = 0; f != factorCount; f++)
+		{
+			setAt(rows - 1, f, testCase.atIndex(f));
+		}
+	}
+
+	//returns the component selected for a factor in a row
+	int at(int row, int factor) const
+	{
+		size_t cell = (size_t)row * factorCount + factor;
+		switch (width)
+		{
+		case 1:
+			return cells[cell];
+		case 2:
+			return ((const uint16_t*)cells.data())[cell];
+		default:
+			return ((const uint32_t*)cells.data())[cell];
+		}
+	}
+
+	//replaces the component selected for a factor in a row
+	void setAt(int row, int factor, int component)
+	{
+		size_t cell = (size_t)row * factorCount + factor;
+		switch (width)
+		{
+		case 1:
+			cells[cell] = (unsigned char)component;
+			break;
+		case 2:
+			((uint16_t*)cells.data())[cell] = (uint16_t)component;
+			break;
+		default:
+			((uint32_t*)cells.data())[cell] = (uint32_t)component;
+			break;
+		}
+	}
+
+	//returns the number of rows (test cases) in the suite
+	int size() const
+	{
+		return rows;
+	}
+
+	//returns the number of factors in every row
+	int factors() const
+	{
+		return factorCount;
+	}
+
+	//returns how many bytes each cell uses
+	int cellWidth() const
+	{
+		return width;
+	}
+
+	//removes the rows marked true, keeping the others in order, and keeps the storage
+	void removeRows(const std::vector<bool>& removed)
+	{
+		size_t rowBytes = (size_t)factorCount * width;
+		int kept = 0;
+		for (int r = 0; r != rows; r++)
+		{
+			if (removed[r])
+			{
+				continue;
+			}
+			if (kept != r)
+			{
+				std::copy(cells.begin() + r * rowBytes, cells.begin() + (r + 1) * rowBytes, cells.begin() + kept * rowBytes);
+			}
+			kept++;
+		}
+		rows = kept;
+		cells.resize(rows * rowBytes);
+	}
+
+	//copies up to maxRows rows into a caller's row-major buffer of component numbers, returns the rows copied
+	int copyRows(int* destination, int maxRows) const
+	{
+		int copied = std::min(rows, maxRows);
+		for (int r = 0; r != copied; r++)
+		{
+			for (int f = 0; f != factorCount; f++)
+			{
+				destination[(size_t)r * factorCount + f] = at(r, f);
+			}
+		}
+		return copied;
+	}
+
+	//print all of the components in a row on a single line
+	void printRow(int row) const
+	{
+		for (int f = 0; f != factorCount; f++)
+		{
+			std::cout << at(row, f) << " ";
 		}
 		std::cout << std::endl;
 	}
+};
+
+//receives a block of buffered suite text, userData is the pointer given to the sink
+typedef void (*SinkWriter)(const char* data, size_t size, void* userData);
+
+/**
+ *
+ *  This class turns test cases into text in the layout of
+ *  testsuite.txt (component numbers separated by spaces,
+ *  one test case per line) and keeps the text in a buffer.
+ *  The buffer is handed to the writer only when it is full
+ *  or when flush() is called, never once per line. The
+ *  writer decides where the text goes, so the generator
+ *  can stream rows without doing any I/O itself.
+ *
+ */
+class RowSink
+{
+private:
+	SinkWriter writer;
+	void* writerData;
+	std::vector<char> buffer;
+	size_t used;
+	long long rowsWritten;
+
+	//appends a component number followed by a space, without going through a stream
+	void appendNumber(unsigned int value)
+	{
+		if (used + 12 > buffer.size())
+		{
+			flush();
+		}
+		char digits[10];
+		int count = 0;
+		do
+		{
+			digits[count++] = '0' + value % 10;
+			value /= 10;
+		} while (value != 0);
+		while (count != 0)
+		{
+			buffer[used++] = digits[--count];
+		}
+		buffer[used++] = ' ';
+	}
+
+	//ends the current row
+	void endRow()
+	{
+		if (used == buffer.size())
+		{
+			flush();
+		}
+		buffer[used++] = '\n';
+		rowsWritten++;
+	}
+public:
+	//creates a sink that hands its text to write in blocks of up to capacity bytes
+	RowSink(SinkWriter write, void* userData, size_t capacity = 1 << 16)
+	{
+		writer = write;
+		writerData = userData;
+		buffer.resize(std::max(capacity, (size_t)16));
+		used = 0;
+		rowsWritten = 0;
+	}
+
+	~RowSink()
+	{
+		flush();
+	}
+
+	//appends a complete test case as a line of text
+	template <typename Index>
+	void writeRow(const BasicTestCase<Index>& testCase)
+	{
+		for (int f = 0; f != testCase.testSize(); f++)
+		{
+			appendNumber(testCase.atIndex(f));
+		}
+		endRow();
+	}
+
+	//appends one row of a suite as a line of text
+	void writeRow(const TestSuite& suite, int row)
+	{
+		for (int f = 0; f != suite.factors(); f++)
+		{
+			appendNumber(suite.at(row, f));
+		}
+		endRow();
+	}
+
+	//appends text that is not a test case, such as a header line
+	void writeText(const std::string& text)
+	{
+		for (int i = 0; i != text.size(); i++)
+		{
+			if (used == buffer.size())
+			{
+				flush();
+			}
+			buffer[used++] = text[i];
+		}
+	}
+
+	//hands everything buffered so far to the writer
+	void flush()
+	{
+		if (used != 0)
+		{
+			writer(buffer.data(), used, writerData);
+			used = 0;
+		}
+	}
+
+	//returns how many test cases have been written
+	long long rows() const
+	{
+		return rowsWritten;
+	}
+};
+
+/**
+ *
+ *  This data structure holds the working buffers that
+ *  testGenerator() needs to build one candidate. Each
+ *  candidate slot keeps its own scratch, so after the first
+ *  test case no candidate allocates memory again.
+ *
+ */
+struct CandidateScratch
+{
+	std::vector<int> factorOrder;
+	std::vector<int> selectedFactors;
+	std::vector<int> maxPairs;
+	std::vector<uint64_t> selectedMask;
+	std::vector<int> levelScores;
+	std::vector<int> levelConflicts;
+};
+
+/**
+ *
+ *  This data structure holds the combinations of components
+ *  that may never appear together in a test case. Forbidden
+ *  pairs are compiled into packed bit rows laid out exactly
+ *  like the coverage grid, so a component is checked
+ *  against a partial test case by ANDing its row with the
+ *  mask of selected components, a few words. Forbidden combinations of three or
+ *  more components are kept in a list and indexed by each of
+ *  their members, so checking a component only looks at the
+ *  few combinations it belongs to.
+ *
+ *  An implication such as "component 4 requires component 9"
+ *  is stored as forbidden pairs between 4 and every other
+ *  level of 9's factor.
+ *
+ */
+class ConstraintSet
+{
+private:
+	int components;
+	int rowWords;
+	int pairCount;
+	std::vector<int> componentFactor;
+	std::vector<int> factorBegin;
+	std::vector<uint64_t> forbiddenRows;
+	std::vector<int> tupleOffset;
+	std::vector<int> tupleComponents;
+	std::vector<std::vector<int>> componentTuples;
+	std::vector<uint64_t> tupleMembers;
+public:
+	ConstraintSet()
+	{
+		components = 0;
+		rowWords = 0;
+		pairCount = 0;
+	}
+
+	//removes every constraint and sizes the set for a model
+	void reset(const std::vector<int>& levels)
+	{
+		components = 0;
+		componentFactor.clear();
+		factorBegin.clear();
+		for (int f = 0; f != levels.size(); f++)
+		{
+			factorBegin.push_back(components);
+			componentFactor.insert(componentFactor.end(), levels[f], f);
+			components += levels[f];
+		}
+		rowWords = (components + 63) / 64;
+		pairCount = 0;
+		forbiddenRows.clear();
+		tupleOffset.assign(1, 0);
+		tupleComponents.clear();
+		componentTuples.assign(components, std::vector<int>());
+		tupleMembers.assign(rowWords, 0);
+	}
+
+	//forbids two components of different factors from appearing together
+	void forbidPair(int first, int second)
+	{
+		if (componentFactor[first] == componentFactor[second] || isForbiddenPair(first, second))
+		{
+			return;
+		}
+		if (forbiddenRows.empty())
+		{
+			forbiddenRows.assign((size_t)components * rowWords, 0);
+		}
+		forbiddenRows[(size_t)first * rowWords + (second >> 6)] |= (uint64_t)1 << (second & 63);
+		forbiddenRows[(size_t)second * rowWords + (first >> 6)] |= (uint64_t)1 << (first & 63);
+		pairCount++;
+	}
+
+	//forbids a combination of components from different factors, pairs go into the bit rows
+	void forbidCombination(const std::vector<int>& combination)
+	{
+		if (combination.size() == 2)
+		{
+			forbidPair(combination[0], combination[1]);
+			return;
+		}
+		int tuple = tupleOffset.size() - 1;
+		for (int i = 0; i != combination.size(); i++)
+		{
+			tupleComponents.push_back(combination[i]);
+			componentTuples[combination[i]].push_back(tuple);
+			tupleMembers[combination[i] >> 6] |= (uint64_t)1 << (combination[i] & 63);
+		}
+		tupleOffset.push_back(tupleComponents.size());
+	}
+
+	//records that the first component may only appear together with the second component's level
+	void require(int component, int required)
+	{
+		int factor = componentFactor[required];
+		for (int other = factorBegin[factor]; other != components && componentFactor[other] == factor; other++)
+		{
+			if (other != required)
+			{
+				forbidPair(component, other);
+			}
+		}
+	}
+
+	//returns true if there are no constraints at all
+	bool empty() const
+	{
+		return pairCount == 0 && tupleOffset.size() == 1;
+	}
+
+	//returns true if any pair is forbidden
+	bool hasPairs() const
+	{
+		return pairCount != 0;
+	}
+
+	//returns true if any combination of three or more components is forbidden
+	bool hasTuples() const
+	{
+		return tupleOffset.size() > 1;
+	}
+
+	//returns the number of forbidden pairs
+	int forbiddenPairs() const
+	{
+		return pairCount;
+	}
+
+	//returns the number of forbidden combinations of three or more components
+	int forbiddenTuples() const
+	{
+		return tupleOffset.size() - 1;
+	}
+
+	//returns true if the two components may never appear together
+	bool isForbiddenPair(int first, int second) const
+	{
+		return !forbiddenRows.empty() && ((forbiddenRows[(size_t)first * rowWords + (second >> 6)] >> (second & 63)) & 1);
+	}
+
+	//returns the packed row of components a component may not appear with (only valid if hasPairs())
+	const uint64_t* forbiddenRow(int component) const
+	{
+		return &forbiddenRows[(size_t)component * rowWords];
+	}
+
+	//returns true if the component is forbidden with any component set in a packed selection mask
+	bool forbidsAny(int component, const uint64_t* selected) const
+	{
+		if (forbiddenRows.empty())
+		{
+			return false;
+		}
+		const uint64_t* forbidden = &forbiddenRows[(size_t)component * rowWords];
+		for (int w = 0; w != rowWords; w++)
+		{
+			if ((forbidden[w] & selected[w]) != 0)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	//returns the components of a forbidden combination
+	const int* tupleBegin(int tuple) const
+	{
+		return &tupleComponents[tupleOffset[tuple]];
+	}
+
+	//returns the number of components in a forbidden combination
+	int tupleSize(int tuple) const
+	{
+		return tupleOffset[tuple + 1] - tupleOffset[tuple];
+	}
+
+	//returns true if adding the component to a partial test case completes a forbidden combination
+	bool completesTuple(int component, const TestCase& partial) const
+	{
+		//most components are in no forbidden combination, which one bit answers
+		if (((tupleMembers[component >> 6] >> (component & 63)) & 1) == 0)
+		{
+			return false;
+		}
+		for (int t = 0; t != componentTuples[component].size(); t++)
+		{
+			int tuple = componentTuples[component][t];
+			bool complete = true;
+			for (int i = tupleOffset[tuple]; i != tupleOffset[tuple + 1] && complete; i++)
+			{
+				int member = tupleComponents[i];
+				complete = member == component || partial.atIndex(componentFactor[member]) == member;
+			}
+			if (complete)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	//returns true if adding the component completes a forbidden combination, given a packed mask of the selected components
+	bool completesTuple(int component, const uint64_t* selected) const
+	{
+		if (((tupleMembers[component >> 6] >> (component & 63)) & 1) == 0)
+		{
+			return false;
+		}
+		for (int t = 0; t != componentTuples[component].size(); t++)
+		{
+			int tuple = componentTuples[component][t];
+			bool complete = true;
+			for (int i = tupleOffset[tuple]; i != tupleOffset[tuple + 1] && complete; i++)
+			{
+				int member = tupleComponents[i];
+				complete = member == component || ((selected[member >> 6] >> (member & 63)) & 1);
+			}
+			if (complete)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	//returns true if the component may be added to a partial test case (unset factors hold -1)
+	bool allows(int component, const TestCase& partial) const
+	{
+		if (hasPairs())
+		{
+			for (int f = 0; f != partial.testSize(); f++)
+			{
+				if (partial.atIndex(f) >= 0 && isForbiddenPair(component, partial.atIndex(f)))
+				{
+					return false;
+				}
+			}
+		}
+		return !hasTuples() || !completesTuple(component, partial);
+	}
+
+	//returns true if a complete test case breaks no constraint
+	bool allowsTestCase(const TestCase& testCase) const
+	{
+		for (int f = 0; f != testCase.testSize(); f++)
+		{
+			if (testCase.atIndex(f) >= 0 && !allows(testCase.atIndex(f), testCase))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+};
+
+/**
+ *
+ *  This data structure tracks which component pairs are
+ *  still uncovered. Each component owns one contiguous row
+ *  of packed bits (64 components per word) and a set bit
+ *  means the pair has not been covered yet. Only pairs of
+ *  components from different factors are ever set, so the
+ *  same-factor blocks that used to hold -1 cost nothing
+ *  beyond a few always-clear bits in each row. They are
+ *  kept rather than packed away so that every row spans
+ *  all components in order, which lets a row be ANDed with
+ *  the mask of a test case's components word for word.
+ *
+ *  example (3 factors, 3 levels each, pair c0/c7 covered):
+ *      c0 c1 c2 c3 c4 c5 c6 c7 c8
+ *  c0:  0  0  0  1  1  1  1  0  1
+ *  c7:  0  1  1  1  1  1  0  0  0
+ *
+ */
+class CoverageGrid
+{
+private:
+	std::vector<uint64_t> bits;
+	std::vector<int> componentFactor;
+	int components;
+	int rowWords;
+public:
+	//constructor to create an empty grid, call reset() before use
+	CoverageGrid()
+	{
+		components = 0;
+		rowWords = 0;
+	}
+
+	//constructor to create a grid with every cross-factor pair uncovered
+	CoverageGrid(std::vector<int>& levels)
+	{
+		reset(levels);
+	}
+
+	//marks every cross-factor pair as uncovered, reusing the existing storage where possible
+	void reset(std::vector<int>& levels)
+	{
+		components = 0;
+		componentFactor.clear();
+		for (int f = 0; f != levels.size(); f++)
+		{
+			for (int l = 0; l != levels[f]; l++)
+			{
+				componentFactor.push_back(f);
+			}
+			components += levels[f];
+		}
+		rowWords = (components + 63) / 64;
+		bits.assign((size_t)components * rowWords, 0);
+
+		//every component in a factor shares one row pattern: all bits set except the factor's own block
+		std::vector<uint64_t> factorRow(rowWords);
+		int factorStart = 0;
+		for (int f = 0; f != levels.size(); f++)
+		{
+			for (int w = 0; w != rowWords; w++)
+			{
+				factorRow[w] = ~(uint64_t)0;
+			}
+			if (components % 64 != 0)
+			{
+				factorRow[rowWords - 1] = ((uint64_t)1 << (components % 64)) - 1;
+			}
+			for (int j = factorStart; j != factorStart + levels[f]; j++)
+			{
+				factorRow[j >> 6] &= ~((uint64_t)1 << (j & 63));
+			}
+			for (int i = factorStart; i != factorStart + levels[f]; i++)
+			{
+				std::copy(factorRow.begin(), factorRow.end(), bits.begin() + (size_t)i * rowWords);
+			}
+			factorStart += levels[f];
+		}
+	}
+
+	//clears every forbidden pair so it is never counted as needing coverage
+	void excludeForbidden(const ConstraintSet& constraints)
+	{
+		if (!constraints.hasPairs())
+		{
+			return;
+		}
+		for (int c = 0; c != components; c++)
+		{
+			const uint64_t* forbidden = constraints.forbiddenRow(c);
+			uint64_t* currentRow = &bits[(size_t)c * rowWords];
+			for (int w = 0; w != rowWords; w++)
+			{
+				currentRow[w] &= ~forbidden[w];
+			}
+		}
+	}
+
+	//returns the number of uncovered pairs left for a component
+	int countUncovered(int component) const
+	{
+		int count = 0;
+		for (int w = 0; w != rowWords; w++)
+		{
+			for (uint64_t word = bits[(size_t)component * rowWords + w]; word != 0; word &= word - 1)
+			{
+				count++;
+			}
+		}
+		return count;
+	}
+
+	//returns one uncovered partner of a component, or -1 if the component has none
+	int firstUncovered(int component) const
+	{
+		for (int w = 0; w != rowWords; w++)
+		{
+			uint64_t word = bits[(size_t)component * rowWords + w];
+			for (int b = 0; b != 64 && word != 0; b++)
+			{
+				if ((word >> b) & 1)
+				{
+					return w * 64 + b;
+				}
+			}
+		}
+		return -1;
+	}
+
+	//replaces the list with every uncovered pair, each once with the lower component first
+	void listUncovered(std::vector<std::pair<int, int>>& pairs) const
+	{
+		pairs.clear();
+		for (int c = 0; c != components; c++)
+		{
+			const uint64_t* currentRow = &bits[(size_t)c * rowWords];
+			for (int w = (c + 1) >> 6; w != rowWords; w++)
+			{
+				uint64_t word = currentRow[w];
+				if (w == (c + 1) >> 6)
+				{
+					word &= ~(uint64_t)0 << ((c + 1) & 63);
+				}
+				for (; word != 0; word &= word - 1)
+				{
+					pairs.push_back(std::make_pair(c, w * 64 + __builtin_ctzll(word)));
+				}
+			}
+		}
+	}
+
+	//returns true if the two components form a pair that still needs to be covered,
+	//RowWords is the row width when the caller knows it at compile time, 0 if not
+	template <int RowWords = 0>
+	bool isUncovered(int first, int second) const
+	{
+		size_t words = RowWords != 0 ? RowWords : rowWords;
+		return (bits[(size_t)first * words + (second >> 6)] >> (second & 63)) & 1;
+	}
+
+	//marks the pair as covered in both components' rows
+	template <int RowWords = 0>
+	void cover(int first, int second)
+	{
+		size_t words = RowWords != 0 ? RowWords : rowWords;
+		bits[(size_t)first * words + (second >> 6)] &= ~((uint64_t)1 << (second & 63));
+		bits[(size_t)second * words + (first >> 6)] &= ~((uint64_t)1 << (first & 63));
+	}
+
+	//returns true if both components belong to the same factor (an illegal pair)
+	bool sameFactor(int first, int second) const
+	{
+		return componentFactor[first] == componentFactor[second];
+	}
+
+	//returns the factor that a component belongs to
+	int factorOf(int component) const
+	{
+		return componentFactor[component];
+	}
+
+	//returns the packed row of uncovered pairs for a component
+	template <int RowWords = 0>
+	const uint64_t* row(int component) const
+	{
+		return &bits[(size_t)component * (RowWords != 0 ? RowWords : rowWords)];
+	}
+
+	//returns how many 64-bit words make up each row
+	int wordsPerRow() const
+	{
+		return rowWords;
+	}
+
+	//returns the total number of components (rows) in the grid
+	int size() const
+	{
+		return components;
+	}
+
+	//returns the number of bytes used to store the pair bits
+	size_t memoryBytes() const
+	{
+		return bits.size() * sizeof(uint64_t);
+	}
+};
+
+/**
+ *
+ *  This class holds the uncovered pairs of a nearly
+ *  finished suite as an explicit list, plus the uncovered
+ *  partners of every component (a compact adjacency list
+ *  rebuilt from the list). Near the end of a suite most of
+ *  the grid is already covered, so scoring a level by
+ *  walking its few listed partners is much cheaper than
+ *  ANDing its whole grid row with the selected components,
+ *  and it gives exactly the same score.
+ *
+ */
+class PairWorklist
+{
+private:
+	std::vector<std::pair<int, int>> pairs;
+	std::vector<int> partnerStart;
+	std::vector<int> partnerList;
+	bool active;
+
+	//rebuilds the partners of every component from the list of pairs
+	void index(int components)
+	{
+		partnerStart.assign(components + 1, 0);
+		for (int i = 0; i != pairs.size(); i++)
+		{
+			partnerStart[pairs[i].first + 1]++;
+			partnerStart[pairs[i].second + 1]++;
+		}
+		for (int c = 0; c != components; c++)
+		{
+			partnerStart[c + 1] += partnerStart[c];
+		}
+		partnerList.resize(2 * pairs.size());
+		std::vector<int> next(partnerStart.begin(), partnerStart.end() - 1);
+		for (int i = 0; i != pairs.size(); i++)
+		{
+			partnerList[next[pairs[i].first]++] = pairs[i].second;
+			partnerList[next[pairs[i].second]++] = pairs[i].first;
+		}
+	}
+public:
+	PairWorklist()
+	{
+		active = false;
+	}
+
+	//empties the list, the grid is used for scoring again
+	void clear()
+	{
+		pairs.clear();
+		active = false;
+	}
+
+	//returns true once the list holds the uncovered pairs
+	bool isActive() const
+	{
+		return active;
+	}
+
+	//lists every uncovered pair of the grid the first time, afterwards drops the pairs covered since
+	void update(const CoverageGrid& grid)
+	{
+		if (!active)
+		{
+			grid.listUncovered(pairs);
+			active = true;
+		}
+		else
+		{
+			pairs.erase(std::remove_if(pairs.begin(), pairs.end(), [&](const std::pair<int, int>& listed)
+			{
+				return !grid.isUncovered(listed.first, listed.second);
+			}), pairs.end());
+		}
+		index(grid.size());
+	}
+
+	//returns the number of pairs in the list
+	int size() const
+	{
+		return pairs.size();
+	}
+
+	//returns the first of a component's uncovered partners
+	const int* partnersBegin(int component) const
+	{
+		return partnerList.data() + partnerStart[component];
+	}
+
+	//returns one past the last of a component's uncovered partners
+	const int* partnersEnd(int component) const
+	{
+		return partnerList.data() + partnerStart[component + 1];
+	}
+};
+
+/**
+ *
+ *  This data structure is the program's random number
+ *  generator (xoshiro256**). A stream is created from the
+ *  run's seed and a stream number, so every suite and every
+ *  candidate gets its own independent sequence that can be
+ *  reproduced exactly from the seed. Creating a stream only
+ *  costs a few multiplications, so streams can be made
+ *  freely on the hot path.
+ *
+ */
+class RandomStream
+{
+private:
+	uint64_t state[4];
+
+	//splitmix64 step used to spread the seed over the whole state
+	static uint64_t splitMix(uint64_t& x)
+	{
+		uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+
+	static uint64_t rotateLeft(uint64_t x, int k)
+	{
+		return (x << k) | (x >> (64 - k));
+	}
+public:
+	//constructor to create the given stream of the given seed
+	RandomStream(uint64_t seed = 0, uint64_t stream = 0)
+	{
+		//hash the stream number separately so nearby streams start far apart
+		uint64_t streamMix = stream;
+		uint64_t x = seed ^ splitMix(streamMix);
+		for (int i = 0; i != 4; i++)
+		{
+			state[i] = splitMix(x);
+		}
+	}
+
+	//returns the next 64 random bits
+	uint64_t next()
+	{
+		uint64_t result = rotateLeft(state[1] * 5, 7) * 9;
+		uint64_t t = state[1] << 17;
+		state[2] ^= state[0];
+		state[3] ^= state[1];
+		state[1] ^= state[2];
+		state[0] ^= state[3];
+		state[2] ^= t;
+		state[3] = rotateLeft(state[3], 45);
+		return result;
+	}
+
+	//returns a uniformly distributed number in [0, bound)
+	unsigned int below(unsigned int bound)
+	{
+		//multiply-shift maps 32 random bits onto the range without a division
+		return (unsigned int)(((next() >> 32) * bound) >> 32);
+	}
+};
+
+/**
+ *
+ *  This data structure holds how many uncovered pairs remain
+ *  for each component, together with the total number of
+ *  uncovered pairs. Components are kept in a bucket queue
+ *  ordered by their remaining count, so the loop condition
+ *  in selectSuite() and the lookup of the components with
+ *  the most uncovered pairs are both O(1). Counts only ever
+ *  go down by one, which is also O(1): the component swaps
+ *  places with the first member of its bucket and the
+ *  bucket boundary moves past it.
+ *
+ *  example (counts 2 0 3 2):
+ *  order:        c1 | c0 c3 | c2
+ *  bucketStart:  0:0  1:1  2:1  3:3  (4:4)
+ *
+ */
+class UncoveredCounts
+{
+private:
+	std::vector<int> remaining;
+	std::vector<int> order;
+	std::vector<int> position;
+	std::vector<int> bucketStart;
+	long long totalUncovered;
+	int maxCount;
+public:
+	UncoveredCounts()
+	{
+		totalUncovered = 0;
+		maxCount = 0;
+	}
+
+	//loads the starting count of every component and sorts them into buckets (strength 3 counts triples, etc.)
+	void reset(const std::vector<int>& counts, int strength = 2)
+	{
+		remaining = counts;
+		maxCount = 0;
+		totalUncovered = 0;
+		for (int c = 0; c != remaining.size(); c++)
+		{
+			maxCount = std::max(maxCount, remaining[c]);
+			totalUncovered += remaining[c];
+		}
+		//every tuple is counted by each of its components
+		totalUncovered /= strength;
+
+		//counting sort of the components by remaining pairs
+		bucketStart.assign(maxCount + 2, 0);
+		for (int c = 0; c != remaining.size(); c++)
+		{
+			bucketStart[remaining[c] + 1]++;
+		}
+		for (int k = 1; k != bucketStart.size(); k++)
+		{
+			bucketStart[k] += bucketStart[k - 1];
+		}
+		order.resize(remaining.size());
+		position.resize(remaining.size());
+		std::vector<int> next(bucketStart.begin(), bucketStart.end() - 1);
+		for (int c = 0; c != remaining.size(); c++)
+		{
+			position[c] = next[remaining[c]]++;
+			order[position[c]] = c;
+		}
+	}
+
+	//returns the number of uncovered pairs left for a component
+	int operator[](int component) const
+	{
+		return remaining[component];
+	}
+
+	//moves a component down one bucket after one of its pairs was covered
+	void decrement(int component)
+	{
+		int count = remaining[component];
+		int swapPosition = bucketStart[count];
+		int swapComponent = order[swapPosition];
+
+		//swap with the first member of the bucket, then shrink the bucket past it
+		order[position[component]] = swapComponent;
+		position[swapComponent] = position[component];
+		order[swapPosition] = component;
+		position[component] = swapPosition;
+		bucketStart[count]++;
+		remaining[component]--;
+
+		//the highest bucket only ever empties, so the max walks down
+		while (maxCount > 0 && bucketStart[maxCount] == order.size())
+		{
+			maxCount--;
+		}
+	}
+
+	//records that one more pair was covered, called once per pair
+	void coverPair(int first, int second)
+	{
+		decrement(first);
+		decrement(second);
+		totalUncovered--;
+	}
+
+	//records that one more tuple of strength t was covered
+	void coverTuple(const int* components, int strength)
+	{
+		for (int i = 0; i != strength; i++)
+		{
+			decrement(components[i]);
+		}
+		totalUncovered--;
+	}
+
+	//returns the total number of uncovered pairs (or tuples) across all components
+	long long uncoveredPairs() const
+	{
+		return totalUncovered;
+	}
+
+	//returns the highest number of uncovered pairs held by any component
+	int maxRemaining() const
+	{
+		return maxCount;
+	}
+
+	//returns how many components share the highest remaining count
+	int bestCount() const
+	{
+		return order.size() - bucketStart[maxCount];
+	}
+
+	//returns one of the components with the highest remaining count (index < bestCount())
+	int best(int index) const
+	{
+		return order[bucketStart[maxCount] + index];
+	}
+};
+
+/**
+ *
+ *  This data structure tracks which t-way tuples (one level
+ *  from each of t different factors) are still uncovered,
+ *  for any strength t >= 2. Every t-subset of factors gets a
+ *  compact rank in [0, C(factors, t)) from the combinatorial
+ *  number system, and each subset owns a block of bits with
+ *  one bit per combination of its factors' levels, laid out
+ *  in mixed radix. A tuple's bit index is therefore:
+ *
+ *    subsetOffset[rank(f0 < f1 < ... )] + mixed-radix(l0, l1, ...)
+ *
+ *  example (strength 3, factors 1 < 2 < 4 with 3, 2, 4 levels):
+ *    rank  = C(1,1) + C(2,2) + C(4,3) = 1 + 1 + 4 = 6
+ *    index = subsetOffset[6] + (l1 * 2 + l2) * 4 + l4
+ *
+ *  A set bit means the tuple has not been covered yet.
+ *
+ */
+class TupleCoverage
+{
+private:
+	int strength;
+	int factorCount;
+	std::vector<int> levels;
+	std::vector<int> componentFactor;
+	std::vector<uint64_t> binomial;
+	std::vector<uint64_t> subsetOffset;
+	std::vector<uint64_t> bits;
+	uint64_t tuples;
+public:
+	TupleCoverage()
+	{
+		strength = 0;
+		factorCount = 0;
+		tuples = 0;
+	}
+
+	//marks every tuple of the given strength as uncovered, reusing the existing storage where possible
+	void reset(std::vector<int>& factorLevels, int t)
+	{
+		strength = t;
+		factorCount = factorLevels.size();
+		levels = factorLevels;
+		componentFactor.clear();
+		for (int f = 0; f != factorCount; f++)
+		{
+			componentFactor.insert(componentFactor.end(), levels[f], f);
+		}
+
+		//Pascal's triangle for C(n, k) with n <= factors and k <= strength
+		binomial.assign((size_t)(factorCount + 1) * (strength + 1), 0);
+		for (int n = 0; n <= factorCount; n++)
+		{
+			binomial[(size_t)n * (strength + 1)] = 1;
+			for (int k = 1; k <= strength && k <= n; k++)
+			{
+				binomial[(size_t)n * (strength + 1) + k] = choose(n - 1, k - 1) + choose(n - 1, k);
+			}
+		}
+
+		//size every subset's block, then turn the sizes into starting offsets
+		uint64_t subsets = choose(factorCount, strength);
+		subsetOffset.assign(subsets + 1, 0);
+		std::vector<int> subset(strength);
+		for (int i = 0; i != strength; i++)
+		{
+			subset[i] = i;
+		}
+		while (strength <= factorCount)
+		{
+			uint64_t blockSize = 1;
+			for (int i = 0; i != strength; i++)
+			{
+				blockSize *= levels[subset[i]];
+			}
+			subsetOffset[subsetRank(subset.data()) + 1] = blockSize;
+
+			//advance to the next t-subset in lexicographic order
+			int i = strength - 1;
+			while (i >= 0 && subset[i] == factorCount - strength + i)
+			{
+				i--;
+			}
+			if (i < 0)
+			{
+				break;
+			}
+			subset[i]++;
+			for (int j = i + 1; j != strength; j++)
+			{
+				subset[j] = subset[j - 1] + 1;
+			}
+		}
+		for (uint64_t r = 1; r <= subsets; r++)
+		{
+			subsetOffset[r] += subsetOffset[r - 1];
+		}
+		tuples = subsetOffset[subsets];
+
+		//every tuple starts uncovered
+		bits.assign((tuples + 63) / 64, ~(uint64_t)0);
+		if (tuples % 64 != 0)
+		{
+			bits.back() = ((uint64_t)1 << (tuples % 64)) - 1;
+		}
+	}
+
+	//returns C(n, k) for n <= factors and k <= strength
+	uint64_t choose(int n, int k) const
+	{
+		if (k < 0 || k > n)
+		{
+			return 0;
+		}
+		return binomial[(size_t)n * (strength + 1) + k];
+	}
+
+	//returns C(n, k) without range checks, for 0 <= n <= factors and 1 <= k <= strength
+	uint64_t chooseUnchecked(int n, int k) const
+	{
+		return binomial[(size_t)n * (strength + 1) + k];
+	}
+
+	//returns the rank of a sorted t-subset of factors
+	uint64_t subsetRank(const int* sortedFactors) const
+	{
+		uint64_t rank = 0;
+		for (int i = 0; i != strength; i++)
+		{
+			rank += choose(sortedFactors[i], i + 1);
+		}
+		return rank;
+	}
+
+	//returns the bit index of a tuple given its sorted factors and each factor's level (0 based)
+	uint64_t tupleIndex(const int* sortedFactors, const int* levelIndices) const
+	{
+		uint64_t index = 0;
+		for (int i = 0; i != strength; i++)
+		{
+			index = index * levels[sortedFactors[i]] + levelIndices[i];
+		}
+		return subsetOffset[subsetRank(sortedFactors)] + index;
+	}
+
+	//returns the first bit index of a sorted t-subset's block
+	uint64_t blockStart(const int* sortedFactors) const
+	{
+		return subsetOffset[subsetRank(sortedFactors)];
+	}
+
+	//returns the first bit index of the block of the t-subset with the given rank
+	uint64_t subsetStart(uint64_t rank) const
+	{
+		return subsetOffset[rank];
+	}
+
+	//returns true if the tuple has not been covered yet
+	bool isUncovered(uint64_t index) const
+	{
+		return (bits[index >> 6] >> (index & 63)) & 1;
+	}
+
+	//marks the tuple as covered
+	void cover(uint64_t index)
+	{
+		bits[index >> 6] &= ~((uint64_t)1 << (index & 63));
+	}
+
+	//marks every tuple whose bit is set in covered (same indexing, set means covered) as covered
+	void coverBits(const std::vector<uint64_t>& covered)
+	{
+		for (size_t w = 0; w != bits.size(); w++)
+		{
+			bits[w] &= ~covered[w];
+		}
+	}
+
+	//returns how many tuples are still uncovered
+	uint64_t uncoveredCount() const
+	{
+		uint64_t count = 0;
+		for (size_t w = 0; w != bits.size(); w++)
+		{
+			count += __builtin_popcountll(bits[w]);
+		}
+		return count;
+	}
+
+	//recovers a tuple's sorted factors and their levels (0 based) from its bit index
+	void decodeTuple(uint64_t index, int* sortedFactors, int* levelIndices) const
+	{
+		uint64_t rank = std::upper_bound(subsetOffset.begin(), subsetOffset.end(), index) - subsetOffset.begin() - 1;
+		uint64_t offset = index - subsetOffset[rank];
+
+		//undo the combinatorial number system from the largest factor down
+		int n = factorCount;
+		for (int i = strength - 1; i >= 0; i--)
+		{
+			do
+			{
+				n--;
+			} while (choose(n, i + 1) > rank);
+			sortedFactors[i] = n;
+			rank -= choose(n, i + 1);
+		}
+
+		//undo the mixed radix from the last factor back
+		for (int i = strength - 1; i >= 0; i--)
+		{
+			levelIndices[i] = offset % levels[sortedFactors[i]];
+			offset /= levels[sortedFactors[i]];
+		}
+	}
+
+	//returns the index of the first uncovered tuple at or after the given index, or tupleCount() if none is left
+	uint64_t nextUncovered(uint64_t from) const
+	{
+		for (uint64_t w = from >> 6; w < bits.size(); w++)
+		{
+			uint64_t word = bits[w];
+			if (w == (from >> 6))
+			{
+				word &= ~(uint64_t)0 << (from & 63);
+			}
+			for (int b = 0; b != 64 && word != 0; b++)
+			{
+				if ((word >> b) & 1)
+				{
+					return w * 64 + b;
+				}
+			}
+		}
+		return tuples;
+	}
+
+	//returns the coverage strength t
+	int getStrength() const
+	{
+		return strength;
+	}
+
+	//returns the number of levels in a factor
+	int levelsIn(int factor) const
+	{
+		return levels[factor];
+	}
+
+	//returns the factor that a component belongs to
+	int factorOf(int component) const
+	{
+		return componentFactor[component];
+	}
+
+	//returns the number of t-subsets of factors
+	uint64_t subsetCount() const
+	{
+		return subsetOffset.size() - 1;
+	}
+
+	//returns the total number of t-way tuples in the model
+	uint64_t tupleCount() const
+	{
+		return tuples;
+	}
+
+	//returns the number of bytes used to store the tuple bits
+	size_t memoryBytes() const
+	{
+		return bits.size() * sizeof(uint64_t);
+	}
+};
+
+/**
+ *
+ *  This data structure holds the test cases a pairwise
+ *  suite is built from, in one cell type.
+ *
+ */
+template <typename Index>
+struct CandidateSlots
+{
+	BasicTestCase<Index> firstSelection;
+	std::vector<BasicTestCase<Index>> candidates;
+};
+
+/**
+ *
+ *  This data structure holds the state that a thread
+ *  needs while building a pairwise suite. One workspace
+ *  exists per thread pool slot, so the grid, pair counts,
+ *  candidate slots and suite matrix are reused from one
+ *  suite to the next, and from one model to the next when
+ *  the caller keeps the workspaces, instead of being
+ *  reallocated. The candidate slots are kept once per cell
+ *  type, so models of different sizes do not take each
+ *  other's slots.
+ *
+ */
+struct SuiteWorkspace
+{
+	CoverageGrid grid;
+	UncoveredCounts pairsRemaining;
+	TestSuite testSuite;
+	CandidateSlots<uint8_t> narrowSlots;
+	CandidateSlots<uint16_t> mediumSlots;
+	CandidateSlots<int> wideSlots;
+	std::vector<CandidateScratch> scratch;
+	PairWorklist worklist;
+
+	//returns the candidate slots of a cell type, chosen by the type of the (unused) argument
+	CandidateSlots<uint8_t>& slots(uint8_t)
+	{
+		return narrowSlots;
+	}
+
+	CandidateSlots<uint16_t>& slots(uint16_t)
+	{
+		return mediumSlots;
+	}
+
+	CandidateSlots<int>& slots(int)
+	{
+		return wideSlots;
+	}
+};
+
+/**
+ *
+ *  This data structure holds the state that a thread
+ *  needs while building a t-way suite, reused from one
+ *  suite to the next like SuiteWorkspace.
+ *
+ */
+struct TupleWorkspace
+{
+	TupleCoverage coverage;
+	UncoveredCounts tuplesRemaining;
+	TestSuite testSuite;
+	TestCase seedSelection;
+	std::vector<TestCase> candidates;
+	std::vector<CandidateScratch> scratch;
+};
+
+/**
+ *
+ *  This data structure holds the state of the IPOG engine
+ *  while it grows a pairwise suite one factor at a time:
+ *  the pair grid, the rows as a row-major matrix of
+ *  components (-1 for a cell not chosen yet), and for every
+ *  row a mask of its chosen components in the grid's row
+ *  layout, which is what the scoring kernel and the
+ *  constraint checks take. Kept from one model to the next
+ *  like SuiteWorkspace.
+ *
+ */
+struct IpogWorkspace
+{
+	CoverageGrid grid;
+	std::vector<int> cells;
+	std::vector<uint64_t> rowMasks;
+	std::vector<uint64_t> placedMask;
+	std::vector<int> scores;
+	std::vector<int> factorOrder;
+	std::vector<TestCase> keptRows;
+};
+
+/**
+ *
+ *  This data structure holds the sizes of the suites
+ *  built while selecting one, how many pairs (or tuples)
+ *  the selected suite had to give up because the
+ *  constraints make them impossible, how many rows the
+ *  reduction and the shrinking removed, how long the
+ *  shrinking took, and how many of the options' seed rows
+ *  it kept.
+ *
+ *  attempts counts every suite that was started, including
+ *  the pruned ones given up as unable to beat the smallest.
+ *  A pruned suite has no size, so largestSuiteSize and
+ *  totalCases only cover the attempts - pruned suites that
+ *  were finished.
+ *
+ */
+struct SuiteStats
+{
+	unsigned int smallestSuiteSize;
+	unsigned int largestSuiteSize;
+	long long totalCases;
+	int attempts;
+	int pruned;
+	int uncoverable;
+	int removedRows;
+	int shrunkRows;
+	long long shrinkMs;
+	int keptRows;
+};
+
+/**
+ *
+ *  This data structure is passed to a progress callback
+ *  every time one of the suites being compared is done.
+ *
+ */
+struct SuiteProgress
+{
+	int attemptsDone;
+	int attempts;
+	unsigned int smallestSuiteSize;
+};
+
+//called once per finished suite, from the thread that built it (calls never overlap)
+typedef void (*ProgressCallback)(const SuiteProgress& progress, void* userData);
+
+/**
+ *
+ *  This data structure holds the result of checking the
+ *  coverage of a suite. coverage starts with every tuple
+ *  the constraints allow set as uncovered and ends with
+ *  only the missing ones set. growth holds (rows read,
+ *  tuples covered) after 1, 2, 4, ... rows and then after
+ *  every chunk of rows. counts holds how many rows cover
+ *  each tuple, in the same indexing, if they were asked
+ *  for, and is empty otherwise.
+ *
+ */
+struct CoverageReport
+{
+	long long rows;
+	uint64_t required;
+	uint64_t forbidden;
+	uint64_t covered;
+	long long invalidRows;
+	TupleCoverage coverage;
+	std::vector<std::pair<long long, uint64_t>> growth;
+	std::vector<uint32_t> counts;
+};
+
+//reads up to maxRows rows of level indices (one int per factor) into cells, returns the rows read, 0 at the end or -1 on an error
+typedef int (*RowSource)(int* cells, int maxRows, void* sourceData);
+
+/**
+ *
+ *  This data structure holds the settings of one
+ *  generation run: the seed every random stream is derived
+ *  from, how many suites to compare (0 for the engine's
+ *  default), whether the selected suite goes through
+ *  reduceSuite(), how many seconds shrinkSuite() may spend
+ *  on a pairwise suite afterwards (0 for none), an optional
+ *  progress callback with a pointer that is handed back to
+ *  it, and an optional sink.
+ *
+ *  The engine is the name of the Generator engine that
+ *  builds the suite ("aetg", "ipog" or "construct"), NULL
+ *  for the construction when it is optimal for the model
+ *  and AETG otherwise.
+ *
+ *  Seed rows are the rows of an existing suite, given as
+ *  components of the current model with -1 for factors
+ *  they do not have yet (a factor added since). They open
+ *  every suite in their order, missing factors filled in by
+ *  the new pairs (or tuples) they make, and only the rows
+ *  needed for what they leave uncovered are generated. A
+ *  seed row that cannot be filled in without breaking a
+ *  constraint is left out.
+ *
+ *  With a sink the selected suite's rows are streamed as
+ *  soon as they are final. With one attempt the suite is
+ *  built greedily and each test case is written the moment
+ *  it is added; with more, the rows are written once those
+ *  attempts are done. Either way the sink is flushed before
+ *  the call returns.
+ *
+ */
+struct GenerationOptions
+{
+	uint64_t seed;
+	int attempts;
+	double deadline;
+	bool adaptive;
+	bool reduce;
+	double shrink;
+	ProgressCallback progress;
+	void* progressData;
+	RowSink* sink;
+	const std::vector<TestCase>* seedRows;
+	const char* engine;
+
+	GenerationOptions()
+	{
+		seed = 0;
+		attempts = 0;
+		deadline = 0;
+		adaptive = false;
+		reduce = false;
+		shrink = 0;
+		progress = NULL;
+		progressData = NULL;
+		sink = NULL;
+		seedRows = NULL;
+		engine = NULL;
+	}
+};
+
+/**
+ *
+ *  This class decides how much search a generation run
+ *  gets. Without a deadline or adaptive mode every attempt
+ *  runs in one parallel loop, exactly as many as asked for.
+ *
+ *  With a deadline (in seconds from start()) attempts that
+ *  have not started when it passes are skipped, and suites
+ *  still being built give up once another suite is done,
+ *  so the run returns the best suite found so far. Since
+ *  the time limit bounds the run, the attempt limit is
+ *  raised so that a long deadline keeps searching.
+ *
+ *  In adaptive mode the attempts run in rounds of a fixed
+ *  size, and the run stops after a few rounds in a row
+ *  that did not make the smallest suite any smaller. The
+ *  rounds and the stopping point only depend on the
+ *  suites, so without a deadline the result still only
+ *  depends on the seed. Adaptive mode also builds more
+ *  candidates for the early test cases, where the choice
+ *  between them covers the most pairs, tapering down to
+ *  the usual number by the end of a suite.
+ *
+ */
+class AttemptBudget
+{
+private:
+	std::chrono::steady_clock::time_point deadline;
+	bool hasDeadline;
+	bool adaptive;
+	int attempts;
+	unsigned int bestSize;
+	int roundsWithoutGain;
+
+	//attempts per round in adaptive mode, and the rounds without a smaller suite before stopping
+	static const int attemptsPerRound = 10;
+	static const int plateauRounds = 3;
+
+	//attempt limit when a deadline or plateau ends the run instead
+	static const int openAttempts = 10000;
+public:
+	AttemptBudget()
+	{
+		hasDeadline = false;
+		adaptive = false;
+		attempts = 0;
+		bestSize = ~0u;
+		roundsWithoutGain = 0;
+	}
+
+	//starts the clock and works out the attempt limit, defaultAttempts is the engine's usual count
+	void start(const GenerationOptions& options, int defaultAttempts)
+	{
+		hasDeadline = options.deadline > 0;
+		adaptive = options.adaptive;
+		deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(options.deadline));
+		attempts = options.attempts > 0 ? options.attempts : (hasDeadline || adaptive ? openAttempts : defaultAttempts);
+		bestSize = ~0u;
+		roundsWithoutGain = 0;
+	}
+
+	//returns the most attempts the run may make
+	int maxAttempts() const
+	{
+		return attempts;
+	}
+
+	//returns how many attempts run in one parallel loop
+	int roundSize() const
+	{
+		return adaptive ? attemptsPerRound : attempts;
+	}
+
+	//returns true once the deadline has passed
+	bool expired() const
+	{
+		return hasDeadline && std::chrono::steady_clock::now() >= deadline;
+	}
+
+	//records the smallest suite after a round, returns false when the run should stop
+	bool nextRound(unsigned int smallestSuiteSize)
+	{
+		if (expired())
+		{
+			return false;
+		}
+		roundsWithoutGain = smallestSuiteSize < bestSize ? 0 : roundsWithoutGain + 1;
+		bestSize = std::min(bestSize, smallestSuiteSize);
+		return !adaptive || roundsWithoutGain < plateauRounds;
+	}
+
+	//returns how many candidates to build for the next test case, given how much is left to cover
+	int candidates(int baseCount, long long remaining, long long total) const
+	{
+		if (!adaptive || total == 0)
+		{
+			return baseCount;
+		}
+
+		//from twice the usual count for the first test case down to the usual count for the last
+		return baseCount + (int)(baseCount * remaining / total);
+	}
+};
+
+/**
+ *
+ *  This class lets the suites being compared give up as
+ *  soon as they cannot beat the smallest finished suite.
+ *  A test case covers at most C(factors, t) of the
+ *  remaining tuples, and at most C(factors - 1, t - 1) of
+ *  those holding any one component. It also holds exactly
+ *  one level of every factor, so the test cases still
+ *  needed by the levels of one factor add up. The largest
+ *  of these counts is a lower bound on the test cases a
+ *  suite still needs, and a suite whose size plus that
+ *  bound is already larger than the best size would lose
+ *  anyway.
+ *  Since it is larger, not just as large, the suite that
+ *  wins (ties go to the lowest key) is the same as without
+ *  pruning.
+ *
+ *  The best size is one atomic value shared by every
+ *  thread, lowered with compare-and-swap and read without
+ *  a lock. With constraints some remaining tuples may turn
+ *  out to be impossible and never need a test case, which
+ *  would make the bound too high, so pruning is only used
+ *  without them.
+ *
+ */
+class SuiteBound
+{
+private:
+	std::atomic<unsigned int> best;
+	std::vector<int> factorBegin;
+	long long perTest;
+	long long perComponent;
+	bool enabled;
+
+	//returns n choose k, small enough for any model that fits in memory
+	static long long choose(int n, int k)
+	{
+		long long result = 1;
+		for (int i = 1; i <= k; i++)
+		{
+			result = result * (n - k + i) / i;
+		}
+		return result;
+	}
+public:
+	SuiteBound() : best(~0u)
+	{
+		perTest = 1;
+		perComponent = 1;
+		enabled = false;
+	}
+
+	//forgets the best size and works out the per-test limits for a model
+	void reset(const std::vector<int>& levels, int strength, bool exact)
+	{
+		int factors = levels.size();
+		best = ~0u;
+		factorBegin.assign(1, 0);
+		for (int f = 0; f != factors; f++)
+		{
+			factorBegin.push_back(factorBegin.back() + levels[f]);
+		}
+		perTest = std::max(1LL, choose(factors, strength));
+		perComponent = std::max(1LL, choose(factors - 1, strength - 1));
+		enabled = exact;
+	}
+
+	//records the size of a finished suite, keeping the smallest
+	void offer(unsigned int size)
+	{
+		unsigned int current = best.load(std::memory_order_relaxed);
+		while (size < current && !best.compare_exchange_weak(current, size, std::memory_order_relaxed))
+		{
+		}
+	}
+
+	//returns true if a suite of this size with these tuples left can no longer beat the best
+	bool cannotBeat(unsigned int size, const UncoveredCounts& remaining) const
+	{
+		if (!enabled)
+		{
+			return false;
+		}
+		unsigned int currentBest = best.load(std::memory_order_relaxed);
+		if (currentBest == ~0u)
+		{
+			return false;
+		}
+		long long needed = (remaining.uncoveredPairs() + perTest - 1) / perTest;
+		if (size + needed > currentBest)
+		{
+			return true;
+		}
+
+		//the levels of a factor never share a test case, so their test cases add up
+		for (int f = 0; f + 1 != factorBegin.size(); f++)
+		{
+			long long factorNeeded = 0;
+			for (int c = factorBegin[f]; c != factorBegin[f + 1]; c++)
+			{
+				factorNeeded += (remaining[c] + perComponent - 1) / perComponent;
+			}
+			needed = std::max(needed, factorNeeded);
+		}
+		return size + needed > currentBest;
+	}
+};
+
+/**
+ *
+ *  This data structure holds a model read from a model
+ *  file: the name and levels of every factor, the coverage
+ *  strength and the constraints between levels. Levels
+ *  given only as a count are named 0, 1, 2 and so on.
+ *
+ */
+struct Model
+{
+	std::string name;
+	int strength;
+	std::vector<std::string> factorNames;
+	std::vector<std::vector<std::string>> levelNames;
+	std::vector<int> levels;
+	ConstraintSet constraints;
+
+	//sets up an unconstrained model from level counts, factors are named F0, F1, ... and levels 0, 1, ...
+	void reset(const std::vector<int>& factorLevels, int t = 2)
+	{
+		strength = t;
+		levels = factorLevels;
+		factorNames.clear();
+		levelNames.assign(levels.size(), std::vector<std::string>());
+		for (int f = 0; f != levels.size(); f++)
+		{
+			factorNames.push_back("F" + std::to_string(f));
+			for (int l = 0; l != levels[f]; l++)
+			{
+				levelNames[f].push_back(std::to_string(l));
+			}
+		}
+		constraints.reset(levels);
+	}
 };
\ No newline at end of file
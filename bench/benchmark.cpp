@@ -0,0 +1,311 @@
+#include "../aetg.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <thread>
+
+using namespace std;
+using namespace std::chrono;
+
+/**
+ *
+ *  Benchmark of fixed, seeded covering array models. Build it from the
+ *  generation code (every source file except main.cpp):
+ *
+ *    g++ -O2 -std=c++11 -pthread bench/benchmark.cpp grid.cpp testcases.cpp
+ *        tway.cpp threadpool.cpp scoring.cpp constraints.cpp model.cpp aetg.cpp
+ *        reduce.cpp suitefile.cpp verify.cpp profile.cpp ipog.cpp shrink.cpp
+ *        construct.cpp
+ *        -o benchmark
+ *
+ *  usage: benchmark [--json FILE] [--baseline FILE] [--only NAME] [--seed N]
+ *                   [--engine aetg|ipog|construct]
+ *
+ *  Every model runs in its own child process so the peak RSS reported
+ *  for it is its own. Results are printed as a table and written as
+ *  JSON (bench_results.json by default), one model per line. Given a
+ *  baseline file from an earlier build, any model whose suite got
+ *  larger or whose wall time grew by more than 10% (and 20 ms, so tiny
+ *  models do not flag timer noise) is reported as a
+ *  regression and the benchmark exits with status 1.
+ *
+ */
+
+//a benchmark model: (levels, number of factors) groups and the best known suite size (0 if not tabulated)
+struct BenchmarkModel
+{
+	const char* name;
+	vector<pair<int, int>> groups;
+	int bestKnown;
+};
+
+//the measurements of one model
+struct BenchmarkResult
+{
+	string name;
+	int factors;
+	int suiteSize;
+	int largestFinishedSuiteSize;
+	long long averageFinishedSuiteSize;
+	int bestKnown;
+	int lowerBound;
+	long long wallMs;
+	double msPerTestCase;
+	long peakRssKb;
+};
+
+//the canonical models, sizes from published covering array tables
+static const BenchmarkModel benchmarkModels[] =
+{
+	{ "3^4", { { 3, 4 } }, 9 },
+	{ "3^13", { { 3, 13 } }, 15 },
+	{ "2^100", { { 2, 100 } }, 10 },
+	{ "10^20", { { 10, 20 } }, 0 },
+	{ "4^15 3^17 2^29", { { 4, 15 }, { 3, 17 }, { 2, 29 } }, 0 },
+	{ "2^100 3^100 4^100 5^100", { { 2, 100 }, { 3, 100 }, { 4, 100 }, { 5, 100 } }, 0 }
+};
+
+/**
+ *
+ *	This function generates one benchmark model inside a
+ *  child process and sends the result line back through a
+ *  pipe. The child builds its own generator, so no
+ *  threads exist at the time of the fork.
+ *
+ *	Returns true if the child finished and its result was read.
+ *
+ */
+static bool runModel(const BenchmarkModel& benchmark, uint64_t seed, const char* engine, BenchmarkResult& result)
+{
+	int channel[2];
+	if (pipe(channel) != 0)
+	{
+		return false;
+	}
+
+	pid_t child = fork();
+	if (child == 0)
+	{
+		close(channel[0]);
+		vector<int> levels;
+		for (int g = 0; g != benchmark.groups.size(); g++)
+		{
+			levels.insert(levels.end(), benchmark.groups[g].second, benchmark.groups[g].first);
+		}
+		Model model;
+		model.reset(levels);
+		Generator generator(0);
+		GenerationOptions options;
+		options.seed = seed;
+		options.engine = engine;
+		TestSuite selectedSuite;
+		SuiteStats stats;
+
+		auto startTime = high_resolution_clock::now();
+		generator.generate(model, options, selectedSuite, stats);
+		auto duration = duration_cast<milliseconds>(high_resolution_clock::now() - startTime);
+
+		ostringstream line;
+		line << selectedSuite.size() << " " << stats.largestSuiteSize << " " << stats.totalCases / (stats.attempts - stats.pruned) << " " << duration.count() << "\n";
+		string text = line.str();
+		ssize_t written = write(channel[1], text.c_str(), text.size());
+		_exit(written == (ssize_t)text.size() ? 0 : 1);
+	}
+	close(channel[1]);
+	if (child < 0)
+	{
+		close(channel[0]);
+		return false;
+	}
+
+	//read the child's result, then collect its resource usage
+	string text;
+	char buffer[256];
+	for (ssize_t count = read(channel[0], buffer, sizeof(buffer)); count > 0; count = read(channel[0], buffer, sizeof(buffer)))
+	{
+		text.append(buffer, count);
+	}
+	close(channel[0]);
+	int status = 0;
+	struct rusage usage;
+	if (wait4(child, &status, 0, &usage) != child || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+	{
+		return false;
+	}
+
+	istringstream fields(text);
+	fields >> result.suiteSize >> result.largestFinishedSuiteSize >> result.averageFinishedSuiteSize >> result.wallMs;
+	result.name = benchmark.name;
+	result.factors = 0;
+	int largest = 0;
+	int secondLargest = 0;
+	for (int g = 0; g != benchmark.groups.size(); g++)
+	{
+		result.factors += benchmark.groups[g].second;
+		for (int f = 0; f != benchmark.groups[g].second && f != 2; f++)
+		{
+			if (benchmark.groups[g].first > largest)
+			{
+				secondLargest = largest;
+				largest = benchmark.groups[g].first;
+			}
+			else if (benchmark.groups[g].first > secondLargest)
+			{
+				secondLargest = benchmark.groups[g].first;
+			}
+		}
+	}
+	result.bestKnown = benchmark.bestKnown;
+	result.lowerBound = largest * secondLargest;
+	result.msPerTestCase = result.suiteSize == 0 ? 0 : (double)result.wallMs / result.suiteSize;
+	result.peakRssKb = usage.ru_maxrss;
+	return !fields.fail();
+}
+
+/**
+ *
+ *	This function reads a number field out of one line of
+ *  a results file written by this benchmark.
+ *
+ *	Returns the value, or -1 if the field is missing.
+ *
+ */
+static long long jsonNumber(const string& line, const string& field)
+{
+	size_t position = line.find("\"" + field + "\": ");
+	if (position == string::npos)
+	{
+		return -1;
+	}
+	return atoll(line.c_str() + position + field.size() + 4);
+}
+
+/**
+ *
+ *	This function compares the results with a results file
+ *  from an earlier build, matching models by name.
+ *
+ *	Returns the number of regressions found.
+ *
+ */
+static int compareBaseline(const string& fileName, vector<BenchmarkResult>& results)
+{
+	ifstream baseline(fileName.c_str());
+	if (!baseline)
+	{
+		cout << "INPUT ERROR: Could not open baseline " << fileName << "." << endl;
+		return 1;
+	}
+
+	int regressions = 0;
+	string line;
+	while (getline(baseline, line))
+	{
+		for (int i = 0; i != results.size(); i++)
+		{
+			if (line.find("\"name\": \"" + results[i].name + "\"") == string::npos)
+			{
+				continue;
+			}
+			long long oldSize = jsonNumber(line, "suiteSize");
+			long long oldMs = jsonNumber(line, "wallMs");
+			if (oldSize >= 0 && results[i].suiteSize > oldSize)
+			{
+				cout << "REGRESSION: " << results[i].name << " suite size " << oldSize << " -> " << results[i].suiteSize << endl;
+				regressions++;
+			}
+			if (oldMs > 0 && results[i].wallMs * 10 > oldMs * 11 && results[i].wallMs - oldMs > 20)
+			{
+				cout << "REGRESSION: " << results[i].name << " wall time " << oldMs << " ms -> " << results[i].wallMs << " ms" << endl;
+				regressions++;
+			}
+		}
+	}
+	return regressions;
+}
+
+int main(int argc, char* argv[])
+{
+	const char* jsonFile = "bench_results.json";
+	const char* baselineFile = NULL;
+	const char* onlyModel = NULL;
+	uint64_t seed = 1;
+	const char* engine = "aetg";
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+		{
+			jsonFile = argv[++i];
+		}
+		else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc)
+		{
+			baselineFile = argv[++i];
+		}
+		else if (strcmp(argv[i], "--only") == 0 && i + 1 < argc)
+		{
+			onlyModel = argv[++i];
+		}
+		else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+		{
+			seed = strtoull(argv[++i], NULL, 10);
+		}
+		else if (strcmp(argv[i], "--engine") == 0 && i + 1 < argc)
+		{
+			engine = argv[++i];
+		}
+		else
+		{
+			cout << "usage: " << argv[0] << " [--json FILE] [--baseline FILE] [--only NAME] [--seed N] [--engine aetg|ipog|construct]" << endl;
+			return 1;
+		}
+	}
+	//a one-thread generator starts no workers, so the check leaves no threads behind for the forks
+	if (Generator(1).engine(engine) == NULL)
+	{
+		cout << "INPUT ERROR: Unknown engine " << engine << ", the engines are aetg, ipog and construct." << endl;
+		return 1;
+	}
+
+	vector<BenchmarkResult> results;
+	cout << "model                      factors   size   best  bound   wall ms  ms/test   peak KB" << endl;
+	for (int m = 0; m != sizeof(benchmarkModels) / sizeof(benchmarkModels[0]); m++)
+	{
+		if (onlyModel != NULL && strcmp(onlyModel, benchmarkModels[m].name) != 0)
+		{
+			continue;
+		}
+		BenchmarkResult result;
+		if (!runModel(benchmarkModels[m], seed, engine, result))
+		{
+			cout << "ERROR: " << benchmarkModels[m].name << " did not finish." << endl;
+			return 1;
+		}
+		results.push_back(result);
+
+		char row[160];
+		snprintf(row, sizeof(row), "%-26s %7d %6d %6d %6d %9lld %8.2f %9ld", result.name.c_str(), result.factors, result.suiteSize, result.bestKnown, result.lowerBound, result.wallMs, result.msPerTestCase, result.peakRssKb);
+		cout << row << endl;
+	}
+
+	//one model per line so the file is easy to diff and to read back as a baseline
+	ofstream json(jsonFile);
+	json << "{\n  \"seed\": " << seed << ",\n  \"engine\": \"" << engine << "\",\n  \"kernel\": \"" << scoringKernelName() << "\",\n  \"threads\": " << thread::hardware_concurrency() << ",\n  \"models\": [\n";
+	for (int i = 0; i != results.size(); i++)
+	{
+		json << "    { \"name\": \"" << results[i].name << "\", \"factors\": " << results[i].factors << ", \"suiteSize\": " << results[i].suiteSize << ", \"largestFinishedSuiteSize\": " << results[i].largestFinishedSuiteSize << ", \"averageFinishedSuiteSize\": " << results[i].averageFinishedSuiteSize << ", \"bestKnown\": " << results[i].bestKnown << ", \"lowerBound\": " << results[i].lowerBound << ", \"wallMs\": " << results[i].wallMs << ", \"msPerTestCase\": " << results[i].msPerTestCase << ", \"peakRssKb\": " << results[i].peakRssKb << " }" << (i + 1 != results.size() ? "," : "") << "\n";
+	}
+	json << "  ]\n}\n";
+	json.close();
+	cout << "Results written to " << jsonFile << endl;
+
+	if (baselineFile != NULL && compareBaseline(baselineFile, results) != 0)
+	{
+		return 1;
+	}
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,111 @@
+#include "aetgfunctions.h"
+#include <fstream>
+#include <sstream>
+
+using namespace std;
+
+/**
+ *
+ *	This function reads constraints from a text file into
+ *  a constraint set. Components are given by the same
+ *  numbers used in the test suite output, one constraint
+ *  per line:
+ *
+ *    forbid 0 5        components 0 and 5 never appear together
+ *    forbid 0 5 9      0, 5 and 9 never all appear together
+ *    require 2 7       component 2 only appears with component 7
+ *
+ *  Blank lines and lines starting with # are ignored. The
+ *  components of one constraint must come from different
+ *  factors.
+ *
+ *	Returns true if the file was read without errors, otherwise
+ *  sets error to the first error found and returns false.
+ *
+ */
+bool loadConstraints(const string& fileName, vector<int>& levels, ConstraintSet& constraints, string& error)
+{
+	ifstream inputFile(fileName.c_str());
+	if (!inputFile)
+	{
+		error = string("Could not open constraint file ") + fileName + ".";
+		return false;
+	}
+
+	int totalComponents = countComponents(levels);
+	vector<int> factorBegin = factorStartingNums(levels);
+	constraints.reset(levels);
+
+	string line;
+	int lineNumber = 0;
+	while (getline(inputFile, line))
+	{
+		lineNumber++;
+		istringstream fields(line);
+		string keyword;
+		if (!(fields >> keyword) || keyword[0] == '#')
+		{
+			continue;
+		}
+
+		//read the components and check that each one is in a different factor
+		vector<int> combination;
+		vector<bool> factorUsed(levels.size(), false);
+		int component = -1;
+		while (fields >> component)
+		{
+			if (component < 0 || component >= totalComponents)
+			{
+				error = string("Component ") + to_string(component) + " on line " + to_string(lineNumber) + " of " + fileName + " does not exist.";
+				return false;
+			}
+			int factor = upper_bound(factorBegin.begin(), factorBegin.end(), component) - factorBegin.begin() - 1;
+			if (factorUsed[factor])
+			{
+				error = string("Line ") + to_string(lineNumber) + " of " + fileName + " uses two components of factor " + to_string(factor) + ".";
+				return false;
+			}
+			factorUsed[factor] = true;
+			combination.push_back(component);
+		}
+		if (!fields.eof())
+		{
+			error = string("Line ") + to_string(lineNumber) + " of " + fileName + " has a value that is not a component number.";
+			return false;
+		}
+
+		if (!applyConstraint(keyword, combination, constraints))
+		{
+			error = string("Line ") + to_string(lineNumber) + " of " + fileName + " should be \"forbid a b [c ...]\" or \"require a b\".";
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ *
+ *	This function adds one constraint line, already turned
+ *  into component numbers from different factors, to a
+ *  constraint set. "forbid" takes two or more components
+ *  and "require" takes exactly two.
+ *
+ *	Returns false if the keyword or the number of components is not valid.
+ *
+ */
+bool applyConstraint(const string& keyword, const vector<int>& combination, ConstraintSet& constraints)
+{
+	if (keyword == "forbid" && combination.size() >= 2)
+	{
+		constraints.forbidCombination(combination);
+	}
+	else if (keyword == "require" && combination.size() == 2)
+	{
+		constraints.require(combination[0], combination[1]);
+	}
+	else
+	{
+		return false;
+	}
+	return true;
+}
\ No newline at end of file
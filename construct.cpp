@@ -0,0 +1,542 @@
+#include "aetgfunctions.h"
+#include <algorithm>
+#include <numeric>
+#include "threadpool.h"
+
+using namespace std;
+
+//the largest field the orthogonal arrays are built over, which keeps the tables of the field small
+static const int maxFieldOrder = 256;
+
+/**
+ *
+ *  This class is the finite field GF(q) of a prime power
+ *  q = p^n, as addition and multiplication tables. An
+ *  element is the number whose base-p digits are the
+ *  coefficients of a polynomial over GF(p), and products
+ *  are taken modulo the first monic irreducible polynomial
+ *  of degree n.
+ *
+ */
+class GaloisField
+{
+private:
+	int order;
+	vector<int> sums;
+	vector<int> products;
+
+	//multiplies two elements as polynomials over GF(p), modulo the monic polynomial x^n + modulus
+	static int multiply(int a, int b, int prime, int power, int modulus)
+	{
+		int digits[16] = { 0 };
+		int left[8];
+		int right[8];
+		int tail[8];
+		for (int i = 0; i != power; i++)
+		{
+			left[i] = a % prime;
+			right[i] = b % prime;
+			tail[i] = modulus % prime;
+			a /= prime;
+			b /= prime;
+			modulus /= prime;
+		}
+		for (int i = 0; i != power; i++)
+		{
+			for (int j = 0; j != power; j++)
+			{
+				digits[i + j] = (digits[i + j] + left[i] * right[j]) % prime;
+			}
+		}
+
+		//x^n is replaced by -(modulus), from the highest digit down
+		for (int d = 2 * power - 2; d >= power; d--)
+		{
+			for (int i = 0; i != power; i++)
+			{
+				digits[d - power + i] = (digits[d - power + i] + (prime - tail[i]) * digits[d]) % prime;
+			}
+			digits[d] = 0;
+		}
+		int product = 0;
+		for (int i = power - 1; i >= 0; i--)
+		{
+			product = product * prime + digits[i];
+		}
+		return product;
+	}
+public:
+	GaloisField()
+	{
+		order = 0;
+	}
+
+	/**
+	 *
+	 *	This function builds the tables of GF(q). A modulus
+	 *  is accepted once no two non-zero elements multiply to
+	 *  zero, which holds exactly for irreducible ones.
+	 *
+	 *	Returns false if q is not a prime power up to maxFieldOrder.
+	 *
+	 */
+	bool reset(int q)
+	{
+		int prime = 0;
+		int power = 0;
+		if (!primePower(q, prime, power))
+		{
+			return false;
+		}
+		order = q;
+		sums.resize(q * q);
+		products.resize(q * q);
+		for (int a = 0; a != q; a++)
+		{
+			for (int b = 0; b != q; b++)
+			{
+				int sum = 0;
+				for (int x = a, y = b, place = 1; place != q; x /= prime, y /= prime, place *= prime)
+				{
+					sum += (x % prime + y % prime) % prime * place;
+				}
+				sums[a * q + b] = sum;
+			}
+		}
+		for (int modulus = 0; modulus != q; modulus++)
+		{
+			bool field = true;
+			for (int a = 1; a != q && field; a++)
+			{
+				for (int b = 1; b != q && field; b++)
+				{
+					products[a * q + b] = multiply(a, b, prime, power, modulus);
+					field = products[a * q + b] != 0;
+				}
+			}
+			if (field)
+			{
+				for (int a = 0; a != q; a++)
+				{
+					products[a] = 0;
+					products[a * q] = 0;
+				}
+				return true;
+			}
+		}
+		return false;
+	}
+
+	//returns a + b
+	int add(int a, int b) const
+	{
+		return sums[a * order + b];
+	}
+
+	//returns a * b
+	int times(int a, int b) const
+	{
+		return products[a * order + b];
+	}
+
+	//returns true if q is p^n for a prime p, and sets them
+	static bool primePower(int q, int& prime, int& power)
+	{
+		if (q < 2 || q > maxFieldOrder)
+		{
+			return false;
+		}
+		prime = 2;
+		while (q % prime != 0)
+		{
+			prime++;
+		}
+		power = 0;
+		for (int rest = q; rest != 1; rest /= prime)
+		{
+			if (rest % prime != 0)
+			{
+				return false;
+			}
+			power++;
+		}
+		return true;
+	}
+};
+
+/**
+ *
+ *	This function builds the orthogonal array OA(q^2, q+1,
+ *  q, 2): row i*q + j holds i in column 0 and j + m*i in
+ *  column m + 1, for every element m. Any two columns hold
+ *  every pair of levels exactly once. Without column 0 (the
+ *  constant rows variant) the q rows with i = 0 hold one
+ *  level in every column, which the product construction
+ *  can merge.
+ *
+ *	Returns no value(s), cells and columns describe the row-major array.
+ *
+ */
+static void orthogonalArray(const GaloisField& field, int q, bool constantRows, vector<int>& cells, int& columns)
+{
+	columns = constantRows ? q : q + 1;
+	cells.resize((size_t)q * q * columns);
+	size_t cell = 0;
+	for (int i = 0; i != q; i++)
+	{
+		for (int j = 0; j != q; j++)
+		{
+			if (!constantRows)
+			{
+				cells[cell++] = i;
+			}
+			for (int m = 0; m != q; m++)
+			{
+				cells[cell++] = field.add(j, field.times(m, i));
+			}
+		}
+	}
+}
+
+/**
+ *
+ *	This function returns the level that every cell of a
+ *  row holds.
+ *
+ *	Returns the level, or -1 if the row holds more than one.
+ *
+ */
+static int constantLevel(const vector<int>& cells, int columns, int row)
+{
+	const int* first = &cells[(size_t)row * columns];
+	for (int c = 1; c != columns; c++)
+	{
+		if (first[c] != first[0])
+		{
+			return -1;
+		}
+	}
+	return first[0];
+}
+
+/**
+ *
+ *	This function builds the product of two strength 2
+ *  covering arrays with the same levels: column (x, y)
+ *  holds column x of the first array in the top rows and
+ *  column y of the second in the bottom rows. Two columns
+ *  with different x are covered by the top, two with the
+ *  same x by the bottom. A bottom row that holds one level
+ *  throughout repeats a top row when the first array has a
+ *  row of that level too, and is left out.
+ *
+ *	Returns no value(s), cells and columns describe the row-major product.
+ *
+ */
+static void productArray(const vector<int>& top, int topColumns, const vector<int>& bottom, int bottomColumns, int q, vector<int>& cells, int& columns)
+{
+	columns = topColumns * bottomColumns;
+	int topRows = top.size() / topColumns;
+	int bottomRows = bottom.size() / bottomColumns;
+	vector<bool> topConstant(q, false);
+	cells.clear();
+	cells.reserve((size_t)(topRows + bottomRows) * columns);
+	for (int r = 0; r != topRows; r++)
+	{
+		int level = constantLevel(top, topColumns, r);
+		if (level >= 0)
+		{
+			topConstant[level] = true;
+		}
+		for (int x = 0; x != topColumns; x++)
+		{
+			cells.insert(cells.end(), bottomColumns, top[(size_t)r * topColumns + x]);
+		}
+	}
+	for (int r = 0; r != bottomRows; r++)
+	{
+		int level = constantLevel(bottom, bottomColumns, r);
+		if (level >= 0 && topConstant[level])
+		{
+			continue;
+		}
+		for (int x = 0; x != topColumns; x++)
+		{
+			cells.insert(cells.end(), bottom.begin() + (size_t)r * bottomColumns, bottom.begin() + (size_t)(r + 1) * bottomColumns);
+		}
+	}
+}
+
+/**
+ *
+ *	This function builds a strength 2 covering array with
+ *  at least k columns of q levels. Up to q + 1 columns it
+ *  is the orthogonal array, which is optimal. Beyond that it
+ *  is the product of an orthogonal array with q or q + 1
+ *  columns and a covering array built the same way for the
+ *  rest, whichever has fewer rows.
+ *
+ *	Returns no value(s), cells and columns describe the row-major array.
+ *
+ */
+static void coveringArray(const GaloisField& field, int q, int k, vector<int>& cells, int& columns)
+{
+	if (k <= q + 1)
+	{
+		orthogonalArray(field, q, k <= q, cells, columns);
+		return;
+	}
+
+	vector<int> top;
+	vector<int> bottom;
+	vector<int> product;
+	int topColumns = 0;
+	int bottomColumns = 0;
+	int productColumns = 0;
+	cells.clear();
+	for (int constantRows = 1; constantRows >= 0; constantRows--)
+	{
+		orthogonalArray(field, q, constantRows, top, topColumns);
+		coveringArray(field, q, (k + topColumns - 1) / topColumns, bottom, bottomColumns);
+		productArray(top, topColumns, bottom, bottomColumns, q, product, productColumns);
+		if (cells.empty() || product.size() / productColumns < cells.size() / columns)
+		{
+			cells.swap(product);
+			columns = productColumns;
+		}
+	}
+}
+
+/**
+ *
+ *	This function builds the optimal strength 2 covering
+ *  array for k two-level columns: N rows, the least with
+ *  k <= C(N-1, ceil(N/2)). Row 0 is all zeros and each
+ *  column holds, in rows 1 to N-1, a different set of
+ *  ceil(N/2) ones. Two such sets each have a one the other
+ *  lacks, and overlap since together they are larger than
+ *  N-1, so every pair of levels appears.
+ *
+ *	Returns no value(s), cells and columns describe the row-major array.
+ *
+ */
+static void binaryArray(int k, vector<int>& cells, int& columns)
+{
+	int rows = 2;
+	for (double sets = 1; sets < k; )
+	{
+		rows++;
+		int ones = (rows + 1) / 2;
+		sets = 1;
+		for (int i = 0; i != ones; i++)
+		{
+			sets = sets * (rows - 1 - i) / (i + 1);
+		}
+	}
+	int ones = (rows + 1) / 2;
+	columns = k;
+	cells.assign((size_t)rows * columns, 0);
+
+	//the sets of ones in lexicographic order
+	vector<int> chosen(ones);
+	iota(chosen.begin(), chosen.end(), 0);
+	for (int c = 0; c != k; c++)
+	{
+		for (int i = 0; i != ones; i++)
+		{
+			cells[(size_t)(chosen[i] + 1) * columns + c] = 1;
+		}
+		int i = ones - 1;
+		while (i >= 0 && chosen[i] == rows - 1 - ones + i)
+		{
+			i--;
+		}
+		if (i < 0)
+		{
+			break;
+		}
+		chosen[i]++;
+		for (int j = i + 1; j != ones; j++)
+		{
+			chosen[j] = chosen[j - 1] + 1;
+		}
+	}
+}
+
+/**
+ *
+ *	This function checks whether a model has a known
+ *  construction: two levels at most, with at least one
+ *  factor of two, or at least two factors sharing the
+ *  largest level count and that count a prime power up to
+ *  maxFieldOrder. The
+ *  product of the two largest level counts is then the
+ *  least any suite can have, and the orthogonal array has
+ *  exactly that many rows.
+ *
+ *	Returns true if constructRows() can build the model's rows.
+ *
+ */
+bool constructionApplies(const vector<int>& levels)
+{
+	if (levels.empty())
+	{
+		return false;
+	}
+	int q = *max_element(levels.begin(), levels.end());
+	int prime = 0;
+	int power = 0;
+	return q == 2 || (count(levels.begin(), levels.end(), q) >= 2 && GaloisField::primePower(q, prime, power));
+}
+
+/**
+ *
+ *	This function checks whether the construction of a
+ *  model that constructionApplies() accepts is optimal: the
+ *  binary array for two levels, or a single orthogonal
+ *  array with a column for every factor of more than one
+ *  level (up to q + 1 of them), whose q^2 rows meet the
+ *  lower bound. The product arrays used past that are
+ *  often larger than what AETG finds.
+ *
+ *	Returns true if the constructed suite has the fewest rows any suite can.
+ *
+ */
+bool constructionOptimal(const vector<int>& levels)
+{
+	int q = *max_element(levels.begin(), levels.end());
+	return q == 2 || levels.size() - count(levels.begin(), levels.end(), 1) <= q + 1;
+}
+
+/**
+ *
+ *	This function builds the rows of a model's suite from a
+ *  construction, see constructionApplies(). The factors
+ *  with the largest level count q get binaryArray() if q is
+ *  2 and coveringArray() otherwise, asked for a column for
+ *  every factor of more than one level up to q + 1 (what
+ *  one orthogonal array holds), and columns
+ *  it has to spare go to the next largest factors, whose
+ *  levels are folded into theirs (level modulo the factor's
+ *  count), which keeps every pair they need. Factors of one
+ *  level hold it in every row. The factors left over hold
+ *  -1 in every row, to be filled in greedily.
+ *
+ *	Returns the number of factors the construction covers.
+ *
+ */
+int constructRows(vector<int>& levels, vector<TestCase>& rows)
+{
+	int factors = levels.size();
+	vector<int> factorBegin = factorStartingNums(levels);
+	int q = *max_element(levels.begin(), levels.end());
+	int largest = count(levels.begin(), levels.end(), q);
+	int multiLevel = factors - count(levels.begin(), levels.end(), 1);
+	vector<int> cells;
+	int columns = 0;
+	if (q == 2)
+	{
+		binaryArray(largest, cells, columns);
+	}
+	else
+	{
+		//the full orthogonal array costs no more rows than the constant rows variant, and has a column more
+		GaloisField field;
+		field.reset(q);
+		coveringArray(field, q, max(largest, min(multiLevel, q + 1)), cells, columns);
+	}
+
+	//the factors with the most levels take the columns, and a factor of one level needs none
+	vector<int> order(factors);
+	iota(order.begin(), order.end(), 0);
+	stable_sort(order.begin(), order.end(), [&](int a, int b)
+	{
+		return levels[a] > levels[b];
+	});
+	int covered = min(columns, (int)(factors - count(levels.begin(), levels.end(), 1)));
+
+	int rowCount = cells.size() / columns;
+	rows.resize(rowCount);
+	for (int r = 0; r != rowCount; r++)
+	{
+		rows[r].reset(factors);
+		for (int c = 0; c != covered; c++)
+		{
+			int f = order[c];
+			rows[r].setComponent(f, factorBegin[f] + cells[(size_t)r * columns + c] % levels[f]);
+		}
+		for (int f = 0; f != factors; f++)
+		{
+			if (levels[f] == 1)
+			{
+				rows[r].setComponent(f, factorBegin[f]);
+			}
+		}
+	}
+	return covered + count(levels.begin(), levels.end(), 1);
+}
+
+/**
+ *
+ *	This function builds a pairwise suite from a
+ *  construction instead of comparing greedy attempts. When
+ *  the construction covers every factor the suite is its
+ *  rows, built in time proportional to their size. Factors
+ *  left over are filled in by selectSuite(), with the
+ *  constructed rows as its seed rows, so only the rows
+ *  needed for what they leave uncovered are added. The
+ *  model must have no constraints, see constructionApplies().
+ *  Like the other engines, finishSuite() then reduces,
+ *  shrinks and writes the suite as the options ask.
+ *
+ *	Returns the caller's suite, holding the constructed test suite.
+ *
+ */
+TestSuite& selectSuiteConstructed(vector<int>& factorLevels, ConstraintSet& constraints, GenerationOptions& options, ThreadPool& pool, vector<SuiteWorkspace>& fillWorkspaces, vector<TestCase>& rows, TestSuite& selectedSuite, SuiteStats& stats)
+{
+	AETG_ATTEMPT(0);
+	int factors = factorLevels.size();
+	stats.smallestSuiteSize = 0;
+	stats.largestSuiteSize = 0;
+	stats.totalCases = 0;
+	stats.attempts = 1;
+	stats.pruned = 0;
+	stats.uncoverable = 0;
+	stats.removedRows = 0;
+	stats.shrunkRows = 0;
+	stats.shrinkMs = 0;
+	stats.keptRows = 0;
+
+	int covered = 0;
+	{
+		AETG_PHASE(phaseFirstCase);
+		covered = constructRows(factorLevels, rows);
+	}
+
+	if (covered != factors)
+	{
+		//the greedy fill compares attempts as usual, then the suite is finished here as a whole
+		GenerationOptions fill = options;
+		fill.seedRows = &rows;
+		fill.reduce = false;
+		fill.shrink = 0;
+		fill.sink = NULL;
+		fill.progress = NULL;
+		selectSuite(factorLevels, constraints, fill, pool, fillWorkspaces, selectedSuite, stats);
+		stats.keptRows = 0;
+	}
+	else
+	{
+		selectedSuite.reset(factors, countComponents(factorLevels));
+		for (int r = 0; r != rows.size(); r++)
+		{
+			selectedSuite.appendRow(rows[r]);
+		}
+		stats.smallestSuiteSize = selectedSuite.size();
+		stats.largestSuiteSize = selectedSuite.size();
+		stats.totalCases = selectedSuite.size();
+	}
+
+	finishSuite(selectedSuite, factorLevels, constraints, options, pool, stats);
+	return selectedSuite;
+}
\ No newline at end of file
@@ -58,98 +58,37 @@ int countComponents(vector<int>& levels)
 	return totalComponents;
 }
 
-/**
- *
- *	This function creates a totalComponents x totalComponents
- *  grid to keep track of all possible component pairs. In the
- *  grid, any illegal pair of components, such as components in
- *  the same category (factor) are marked as -1. Any unpaired
- *  components are marked as 0 and any paired components are
- *  marked as 1.
- * 
- *  example:
- *      c0 c1 c2 c3 c4 c5 c6 c7 c8
- *  c0: -1 -1 -1  0  0  0  0  1  0
- *  c1: -1 -1 -1  0  0  0  0  0  0
- *  c2: -1 -1 -1  0  0  0  0  0  0
- *  c3:  0  0  0 -1 -1 -1  0  0  0
- *  c4:  0  0  0 -1 -1 -1  0  0  0
- *  c5:  0  0  0 -1 -1 -1  0  0  0
- *  c6:  0  0  0  0  0  0 -1 -1 -1
- *  c7:  1  0  0  0  0  0 -1 -1 -1
- *  c8:  0  0  0  0  0  0 -1 -1 -1
- *
- *	grid[0][1] == -1 ---> components 0 and 1 are in the same factor
- *  grid[0][5] ==  0 ---> components 0 and 5 have not yet been paired
- *  grid[0][7] ==  1 ---> components 0 and 7 have been paired
- *
- *	Returns the initialized grid with all possible pairs uncovered (0 in all legal positions).
- *
- */
-vector<vector<int>> componentGrid(int factors, vector<int>& levels, int totalComponents)
-{
-	//initialize size of grid's 2D vector and track where current and next factors begin
-	vector<vector<int>> grid(totalComponents, vector<int>(totalComponents, 0));
-	int currentFactor = 0;
-	int currentFactorStart = 0;
-	int nextFactorStart = currentFactorStart + levels[currentFactor];
-
-	//ensure that the function stays in bounds of total factors
-	while (currentFactor != (levels.size() - 1))
-	{
-		//for each level in each factor, don't combine with levels in the same factor
-		for (int i = currentFactorStart; i != nextFactorStart; i++)
-		{
-			for (int j = currentFactorStart; j != nextFactorStart; j++)
-			{
-				grid[i][j] = -1;
-			}
-
-			//when finished with a factor's levels, update the next factor's first number
-			if ((i + 1) % nextFactorStart == 0 && currentFactor != (levels.size() - 1))
-			{
-				currentFactor++;
-				currentFactorStart = nextFactorStart;
-				nextFactorStart += levels[currentFactor];
-			}
-		}
-	}
-	return grid;
-}
-
 /**
  *
  *	This function prints the grid's current state in a
  *	user-friendly format. Any incompatible pairs are marked
  *  with 'x' while any components which are not yet paired
- *  are marked with '-' instead of -1 or 0, respectively.
- *  All covered pairs remain marked as 1.
+ *  are marked with '-'. All covered pairs are marked as 1.
  *
  *	Returns no value(s).
  *
  */
-void printGrid(vector<vector<int>>& grid)
+void printGrid(CoverageGrid& grid)
 {
-	//prints the outer vector as rows of corresponding symbols in the grid
+	//prints each component's row of corresponding symbols in the grid
 	for (int i = 0; i != grid.size(); i++)
 	{
 		cout << "outer " << setw(3) << i << ": ";
 		
-		//prints each component in the row one by one, replacing symbols as needed
-		for (int j = 0; j != grid[i].size(); j++)
+		//prints each pair in the row one by one, replacing bits with symbols
+		for (int j = 0; j != grid.size(); j++)
 		{
-			//replace 0s with '-' and -1s with 'x'
-			if (grid[i][j] == 0)
+			if (grid.sameFactor(i, j))
 			{
-				cout << "-";
+				cout << "x";
 			}
-			else if (grid[i][j] == -1)
+			else if (grid.isUncovered(i, j))
 			{
-				cout << "x";
+				cout << "-";
 			}
 			else
 			{
-				cout << grid[i][j];
+				cout << 1;
 			}
 		}
 		cout << endl;
@@ -0,0 +1,357 @@
+#include "aetgfunctions.h"
+#include <algorithm>
+#include <numeric>
+#include "threadpool.h"
+
+using namespace std;
+
+/**
+ *
+ *	This function checks whether a component can join a
+ *  row of the IPOG matrix, given the components the row
+ *  has chosen so far (its mask).
+ *
+ *	Returns true if no constraint forbids the component in the row.
+ *
+ */
+static bool ipogAllows(int component, const uint64_t* rowMask, ConstraintSet& constraints)
+{
+	if (constraints.empty())
+	{
+		return true;
+	}
+	if (constraints.forbidsAny(component, rowMask))
+	{
+		AETG_COUNT(counterConstraintRejects, 1);
+		return false;
+	}
+	if (constraints.hasTuples() && constraints.completesTuple(component, rowMask))
+	{
+		AETG_COUNT(counterConstraintRejects, 1);
+		return false;
+	}
+	return true;
+}
+
+/**
+ *
+ *	This function chooses a component for one cell of a
+ *  row, marks it in the row's mask and covers the pairs it
+ *  makes with every other chosen cell of the row.
+ *
+ */
+static void ipogSetCell(IpogWorkspace& workspace, int factors, int row, int factor, int component)
+{
+	int rowWords = workspace.grid.wordsPerRow();
+	workspace.cells[(size_t)row * factors + factor] = component;
+	workspace.rowMasks[(size_t)row * rowWords + (component >> 6)] |= (uint64_t)1 << (component & 63);
+	const int* cells = &workspace.cells[(size_t)row * factors];
+	for (int f = 0; f != factors; f++)
+	{
+		if (f != factor && cells[f] >= 0)
+		{
+			workspace.grid.cover(component, cells[f]);
+		}
+	}
+}
+
+/**
+ *
+ *	This function adds an empty row (every cell -1) to the
+ *  IPOG matrix.
+ *
+ *	Returns the index of the new row.
+ *
+ */
+static int ipogAddRow(IpogWorkspace& workspace, int factors, int& rows)
+{
+	workspace.cells.resize((size_t)(rows + 1) * factors, -1);
+	workspace.rowMasks.resize((size_t)(rows + 1) * workspace.grid.wordsPerRow(), 0);
+	return rows++;
+}
+
+/**
+ *
+ *	This function builds a pairwise suite with IPOG (in
+ *  parameter order). The factors are taken with the most
+ *  levels first, and the suite starts as every allowed
+ *  combination of the first two. Each further factor is
+ *  then added in two steps:
+ *
+ *  horizontal: every existing row gets the level of the new
+ *  factor that covers the most uncovered pairs with the
+ *  row's chosen cells (scored by scoreLevels() against the
+ *  row's mask, ties to the lowest level), or stays open if
+ *  no level covers anything new or every level is
+ *  forbidden in the row.
+ *
+ *  vertical: each pair between the new factor and an
+ *  earlier one that is still uncovered goes into the first
+ *  row whose cells for the two factors are open or already
+ *  hold the pair's components, and into a new row holding
+ *  only the pair if there is none.
+ *
+ *  Cells still open at the end get the lowest level the
+ *  constraints allow. Every choice is deterministic, so the
+ *  seed and the number of attempts in the options do not
+ *  matter and one suite is built. It is usually larger than
+ *  the smallest of many AETG attempts, but the work grows
+ *  with the rows times the factors instead of with the
+ *  candidates times the rows times the factors, which is
+ *  what makes it the faster engine for models with hundreds
+ *  of factors.
+ *
+ *  A row that can not be finished without breaking a
+ *  constraint (only possible with forbidden tuples or
+ *  required pairs) is dropped, and the rows that are left go
+ *  to selectSuite() as seed rows of a single attempt, which
+ *  covers what the dropped rows held. Like selectSuite(),
+ *  the suite is shrunk by reduceSuite() when reduce is set
+ *  and by shrinkSuite() when a shrink time is, and written
+ *  to the sink in the options when there is one.
+ *
+ *	Returns the caller's suite, holding the generated test suite.
+ *
+ */
+TestSuite& selectSuiteIPOG(vector<int>& factorLevels, ConstraintSet& constraints, GenerationOptions& options, ThreadPool& pool, IpogWorkspace& workspace, vector<SuiteWorkspace>& topUpWorkspaces, TestSuite& selectedSuite, SuiteStats& stats)
+{
+	AETG_ATTEMPT(0);
+	int factors = factorLevels.size();
+	vector<int> factorBegin = factorStartingNums(factorLevels);
+	int totalComponents = countComponents(factorLevels);
+	stats.smallestSuiteSize = 0;
+	stats.largestSuiteSize = 0;
+	stats.totalCases = 0;
+	stats.attempts = 1;
+	stats.pruned = 0;
+	stats.uncoverable = 0;
+	stats.removedRows = 0;
+	stats.shrunkRows = 0;
+	stats.shrinkMs = 0;
+	stats.keptRows = 0;
+
+	CoverageGrid& grid = workspace.grid;
+	grid.reset(factorLevels);
+	grid.excludeForbidden(constraints);
+	int rowWords = grid.wordsPerRow();
+	workspace.cells.clear();
+	workspace.rowMasks.clear();
+	workspace.placedMask.assign(rowWords, 0);
+	int rows = 0;
+
+	//the factors with the most levels go first, since the first two fix the size of the starting block
+	vector<int>& order = workspace.factorOrder;
+	order.resize(factors);
+	iota(order.begin(), order.end(), 0);
+	stable_sort(order.begin(), order.end(), [&](int a, int b)
+	{
+		return factorLevels[a] > factorLevels[b];
+	});
+
+	//a model with one factor is just its levels
+	if (factors == 1)
+	{
+		for (int l = 0; l != factorLevels[0]; l++)
+		{
+			int row = ipogAddRow(workspace, factors, rows);
+			ipogSetCell(workspace, factors, row, 0, l);
+		}
+	}
+
+	//the suite starts as every combination of the first two factors that the constraints allow
+	if (factors >= 2)
+	{
+		AETG_PHASE(phaseFirstCase);
+		int first = order[0];
+		int second = order[1];
+		for (int a = 0; a != factorLevels[first]; a++)
+		{
+			for (int b = 0; b != factorLevels[second]; b++)
+			{
+				if (constraints.isForbiddenPair(factorBegin[first] + a, factorBegin[second] + b))
+				{
+					continue;
+				}
+				int row = ipogAddRow(workspace, factors, rows);
+				ipogSetCell(workspace, factors, row, first, factorBegin[first] + a);
+				ipogSetCell(workspace, factors, row, second, factorBegin[second] + b);
+			}
+		}
+		for (int p = 0; p != 2; p++)
+		{
+			for (int c = factorBegin[order[p]]; c != factorBegin[order[p]] + factorLevels[order[p]]; c++)
+			{
+				workspace.placedMask[c >> 6] |= (uint64_t)1 << (c & 63);
+			}
+		}
+	}
+
+	workspace.scores.resize(*max_element(factorLevels.begin(), factorLevels.end()));
+	for (int p = 2; p < factors; p++)
+	{
+		int factor = order[p];
+		int begin = factorBegin[factor];
+		int levels = factorLevels[factor];
+
+		//horizontal: each row takes the level that covers the most new pairs with what it holds
+		{
+			AETG_PHASE(phaseCandidates);
+			for (int row = 0; row != rows; row++)
+			{
+				const uint64_t* rowMask = &workspace.rowMasks[(size_t)row * rowWords];
+				scoreLevels(grid.row(begin), levels, rowWords, rowMask, workspace.scores.data());
+				AETG_COUNT(counterGridProbes, levels);
+				int best = -1;
+				int bestScore = 0;
+				for (int l = 0; l != levels; l++)
+				{
+					if (workspace.scores[l] > bestScore && ipogAllows(begin + l, rowMask, constraints))
+					{
+						best = l;
+						bestScore = workspace.scores[l];
+					}
+				}
+				if (best >= 0)
+				{
+					ipogSetCell(workspace, factors, row, factor, begin + best);
+				}
+			}
+		}
+
+		//vertical: the pairs the rows could not take go into open cells, or into new rows
+		{
+			AETG_PHASE(phaseBuildAround);
+			for (int l = 0; l != levels; l++)
+			{
+				int component = begin + l;
+				const uint64_t* uncovered = grid.row(component);
+				for (int w = 0; w != rowWords; w++)
+				{
+					for (uint64_t word = uncovered[w] & workspace.placedMask[w]; word != 0; word &= word - 1)
+					{
+						int partner = w * 64 + __builtin_ctzll(word);
+						AETG_COUNT(counterPartnerProbes, 1);
+
+						//covering an earlier pair can also cover this one
+						if (!grid.isUncovered(component, partner))
+						{
+							continue;
+						}
+						int partnerFactor = grid.factorOf(partner);
+						int chosen = -1;
+						for (int row = 0; row != rows && chosen < 0; row++)
+						{
+							int* cells = &workspace.cells[(size_t)row * factors];
+							uint64_t* rowMask = &workspace.rowMasks[(size_t)row * rowWords];
+							bool openHere = cells[factor] < 0;
+							bool openPartner = cells[partnerFactor] < 0;
+							if ((!openHere && cells[factor] != component) || (!openPartner && cells[partnerFactor] != partner))
+							{
+								continue;
+							}
+							if (openHere && !ipogAllows(component, rowMask, constraints))
+							{
+								continue;
+							}
+
+							//the partner is checked as if the component were already in the row
+							uint64_t componentBit = (uint64_t)1 << (component & 63);
+							uint64_t savedWord = rowMask[component >> 6];
+							rowMask[component >> 6] |= componentBit;
+							if (!openPartner || ipogAllows(partner, rowMask, constraints))
+							{
+								chosen = row;
+							}
+							rowMask[component >> 6] = savedWord;
+						}
+						if (chosen < 0)
+						{
+							chosen = ipogAddRow(workspace, factors, rows);
+						}
+						const int* cells = &workspace.cells[(size_t)chosen * factors];
+						if (cells[factor] < 0)
+						{
+							ipogSetCell(workspace, factors, chosen, factor, component);
+						}
+						if (cells[partnerFactor] < 0)
+						{
+							ipogSetCell(workspace, factors, chosen, partnerFactor, partner);
+						}
+					}
+				}
+			}
+		}
+
+		for (int c = begin; c != begin + levels; c++)
+		{
+			workspace.placedMask[c >> 6] |= (uint64_t)1 << (c & 63);
+		}
+	}
+
+	//open cells take the lowest level allowed, and a row with a cell that has none is dropped
+	AETG_PHASE(phaseSelection);
+	vector<TestCase>& keptRows = workspace.keptRows;
+	keptRows.resize(rows);
+	int kept = 0;
+	for (int row = 0; row != rows; row++)
+	{
+		const uint64_t* rowMask = &workspace.rowMasks[(size_t)row * rowWords];
+		bool complete = true;
+		for (int f = 0; f != factors && complete; f++)
+		{
+			if (workspace.cells[(size_t)row * factors + f] >= 0)
+			{
+				continue;
+			}
+			int l = 0;
+			while (l != factorLevels[f] && !ipogAllows(factorBegin[f] + l, rowMask, constraints))
+			{
+				l++;
+			}
+			if (l == factorLevels[f])
+			{
+				complete = false;
+				break;
+			}
+			//nothing is left to cover, so the cell is only marked for the constraint checks of the next ones
+			int component = factorBegin[f] + l;
+			workspace.cells[(size_t)row * factors + f] = component;
+			workspace.rowMasks[(size_t)row * rowWords + (component >> 6)] |= (uint64_t)1 << (component & 63);
+		}
+		if (complete)
+		{
+			TestCase& testCase = keptRows[kept++];
+			testCase.reset(factors);
+			for (int f = 0; f != factors; f++)
+			{
+				testCase.setComponent(f, workspace.cells[(size_t)row * factors + f]);
+			}
+		}
+	}
+	keptRows.resize(kept);
+
+	//rows were dropped, so a single AETG attempt built on the rest covers the pairs they held
+	if (kept != rows)
+	{
+		GenerationOptions topUp;
+		topUp.seed = options.seed;
+		topUp.attempts = 1;
+		topUp.seedRows = &keptRows;
+		selectSuite(factorLevels, constraints, topUp, pool, topUpWorkspaces, selectedSuite, stats);
+		stats.keptRows = 0;
+	}
+	else
+	{
+		selectedSuite.reset(factors, totalComponents);
+		for (int r = 0; r != kept; r++)
+		{
+			selectedSuite.appendRow(keptRows[r]);
+		}
+		stats.smallestSuiteSize = selectedSuite.size();
+		stats.largestSuiteSize = selectedSuite.size();
+		stats.totalCases = selectedSuite.size();
+	}
+
+	finishSuite(selectedSuite, factorLevels, constraints, options, pool, stats);
+	return selectedSuite;
+}
\ No newline at end of file
@@ -1,6 +1,8 @@
-#include "aetgfunctions.h"
+#include "aetg.h"
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
+#include <sys/stat.h>
 #include <random>
 #include <algorithm>
 #include <numeric>
@@ -9,27 +11,401 @@
 using namespace std;
 using namespace std::chrono;
 
-int main()
+/**
+ *
+ *	This function reads a time budget such as 2s, 1.5s or
+ *  500ms from the command line. Plain numbers are seconds.
+ *
+ *	Returns the time in seconds, or 0 if it is not a valid time.
+ *
+ */
+static double parseSeconds(const char* text)
 {
-	//seed the random number generator for the entire program
-	srand(rand() ^ time(0));
-	
-	//create vector for input and prompt user for desired factors and levels per factor
-	vector<int> factorLevels;
-	inputFactorLevels(factorLevels);
+	char* unit = NULL;
+	double seconds = strtod(text, &unit);
+	if (strcmp(unit, "ms") == 0)
+	{
+		seconds /= 1000;
+	}
+	else if (strcmp(unit, "s") != 0 && *unit != '\0')
+	{
+		seconds = 0;
+	}
+	return seconds > 0 ? seconds : 0;
+}
+
+/**
+ *
+ *	This function checks whether two paths name the same
+ *  existing file, however each of them is spelled.
+ *
+ *	Returns true if both exist and are the same file.
+ *
+ */
+static bool sameFile(const string& first, const string& second)
+{
+	struct stat firstInfo;
+	struct stat secondInfo;
+	if (stat(first.c_str(), &firstInfo) != 0 || stat(second.c_str(), &secondInfo) != 0)
+	{
+		return false;
+	}
+	return firstInfo.st_dev == secondInfo.st_dev && firstInfo.st_ino == secondInfo.st_ino;
+}
+
+/**
+ *
+ *	This function writes the profile of the run, as JSON
+ *  and as trace events, to the files asked for.
+ *
+ *	Returns false if a file could not be written.
+ *
+ */
+static bool writeProfiles(const char* profileFile, const char* traceFile)
+{
+	bool written = true;
+	if (profileFile != NULL && !writeProfileJson(profileFile))
+	{
+		cout << "OUTPUT ERROR: Could not write " << profileFile << "." << endl;
+		written = false;
+	}
+	if (traceFile != NULL && !writeProfileTrace(traceFile))
+	{
+		cout << "OUTPUT ERROR: Could not write " << traceFile << "." << endl;
+		written = false;
+	}
+	return written;
+}
+
+int main(int argc, char* argv[])
+{
+	//seed the random number generator for the entire program, --seed makes a run reproducible
+	random_device device;
+	uint64_t seed = ((uint64_t)device() << 32) ^ device() ^ (uint64_t)time(0);
+	int strength = 2;
+	const char* constraintFile = NULL;
+	const char* modelFile = NULL;
+	const char* batchPath = NULL;
+	const char* outputDirectory = ".";
+	int streamAttempts = 0;
+	const char* binaryFile = NULL;
+	double deadline = 0;
+	bool adaptive = false;
+	bool reduce = false;
+	double shrink = 0;
+	const char* extendFile = NULL;
+	const char* verifyFile = NULL;
+	const char* reportFile = NULL;
+	const char* profileFile = NULL;
+	const char* traceFile = NULL;
+	const char* engineName = NULL;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+		{
+			seed = strtoull(argv[++i], NULL, 10);
+		}
+		else if (strcmp(argv[i], "--strength") == 0 && i + 1 < argc)
+		{
+			strength = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--constraints") == 0 && i + 1 < argc)
+		{
+			constraintFile = argv[++i];
+		}
+		else if (strcmp(argv[i], "--model") == 0 && i + 1 < argc)
+		{
+			modelFile = argv[++i];
+		}
+		else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc)
+		{
+			batchPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+		{
+			outputDirectory = argv[++i];
+		}
+		else if (strcmp(argv[i], "--deadline") == 0 && i + 1 < argc)
+		{
+			deadline = parseSeconds(argv[++i]);
+			if (deadline <= 0)
+			{
+				cout << "INPUT ERROR: --deadline needs a time such as 2s or 500ms." << endl;
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "--shrink") == 0 && i + 1 < argc)
+		{
+			shrink = parseSeconds(argv[++i]);
+			if (shrink <= 0)
+			{
+				cout << "INPUT ERROR: --shrink needs a time such as 2s or 500ms." << endl;
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "--adaptive") == 0)
+		{
+			adaptive = true;
+		}
+		else if (strcmp(argv[i], "--extend") == 0 && i + 1 < argc)
+		{
+			extendFile = argv[++i];
+		}
+		else if (strcmp(argv[i], "--verify") == 0 && i + 1 < argc)
+		{
+			verifyFile = argv[++i];
+		}
+		else if (strcmp(argv[i], "--report") == 0 && i + 1 < argc)
+		{
+			reportFile = argv[++i];
+		}
+		else if (strcmp(argv[i], "--profile") == 0 && i + 1 < argc)
+		{
+			profileFile = argv[++i];
+		}
+		else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+		{
+			traceFile = argv[++i];
+		}
+		else if (strcmp(argv[i], "--engine") == 0 && i + 1 < argc)
+		{
+			engineName = argv[++i];
+		}
+		else if (strcmp(argv[i], "--reduce") == 0)
+		{
+			reduce = true;
+		}
+		else if (strcmp(argv[i], "--binary") == 0 && i + 1 < argc)
+		{
+			binaryFile = argv[++i];
+		}
+		else if (strcmp(argv[i], "--stream") == 0 && i + 1 < argc)
+		{
+			streamAttempts = atoi(argv[++i]);
+			if (streamAttempts < 1)
+			{
+				cout << "INPUT ERROR: --stream needs at least 1 attempt." << endl;
+				return 1;
+			}
+		}
+		else
+		{
+			cout << "usage: " << argv[0] << " [--seed N] [--strength T] [--constraints FILE | --model FILE | --batch DIR|MANIFEST [--output DIR]] [--stream ATTEMPTS] [--binary FILE] [--deadline TIME] [--adaptive] [--reduce] [--shrink TIME] [--engine aetg|ipog|construct] [--extend SUITE] [--verify SUITE [--report FILE]] [--profile JSON] [--trace JSON]" << endl;
+			return 1;
+		}
+	}
+	if (strength < 2 || strength > 6)
+	{
+		cout << "INPUT ERROR: --strength must be between 2 and 6." << endl;
+		return 1;
+	}
+	if (constraintFile != NULL && (modelFile != NULL || batchPath != NULL))
+	{
+		cout << "INPUT ERROR: Model files hold their own constraints, --constraints only applies to prompted models." << endl;
+		return 1;
+	}
+	if (streamAttempts != 0 && batchPath != NULL)
+	{
+		cout << "INPUT ERROR: --stream writes one suite to standard output and cannot be used with --batch." << endl;
+		return 1;
+	}
+	if ((reduce || shrink > 0) && streamAttempts == 1)
+	{
+		cout << "INPUT ERROR: --stream 1 writes each row as it is chosen, so the suite cannot be reduced afterwards." << endl;
+		return 1;
+	}
+	if (extendFile != NULL && modelFile == NULL)
+	{
+		cout << "INPUT ERROR: --extend matches the suite's level names to a model, so it needs --model." << endl;
+		return 1;
+	}
+	if ((profileFile != NULL || traceFile != NULL) && !profilingEnabled())
+	{
+		cout << "INPUT ERROR: --profile and --trace need a build with -DAETG_PROFILE." << endl;
+		return 1;
+	}
+	if (verifyFile != NULL && batchPath != NULL)
+	{
+		cout << "INPUT ERROR: --verify checks one suite and cannot be used with --batch." << endl;
+		return 1;
+	}
+	if (reportFile != NULL && verifyFile == NULL)
+	{
+		cout << "INPUT ERROR: --report is written by --verify." << endl;
+		return 1;
+	}
+	if (binaryFile != NULL && batchPath != NULL)
+	{
+		cout << "INPUT ERROR: --binary names the file of one suite and cannot be used with --batch." << endl;
+		return 1;
+	}
+
+	//start one worker per hardware thread, shared by every suite
+	Generator generator(0);
+	GenerationOptions options;
+	options.seed = seed;
+	options.deadline = deadline;
+	options.adaptive = adaptive;
+	options.reduce = reduce;
+	options.shrink = shrink;
+	options.engine = engineName;
+	if (engineName != NULL && generator.engine(engineName) == NULL)
+	{
+		cout << "INPUT ERROR: Unknown engine " << engineName << ", the engines are aetg, ipog and construct." << endl;
+		return 1;
+	}
+
+	//a batch generates every model in one process, sharing the pool and the workspaces
+	if (batchPath != NULL)
+	{
+		bool generated = runBatch(batchPath, outputDirectory, strength, options, generator);
+		return writeProfiles(profileFile, traceFile) && generated ? 0 : 1;
+	}
+
+	Model model;
+	string error;
+	if (modelFile != NULL)
+	{
+		//read the factors, levels, strength and constraints from the model file
+		if (!loadModel(modelFile, model, strength, error))
+		{
+			cout << "INPUT ERROR: " << error << endl;
+			return 1;
+		}
+	}
+	else if (verifyFile != NULL && isSuiteFile(verifyFile))
+	{
+		//a binary suite file holds the levels of its model
+		MappedSuite suiteFile;
+		if (!suiteFile.open(verifyFile, error))
+		{
+			cout << "INPUT ERROR: " << error << endl;
+			return 1;
+		}
+		model.reset(suiteFile.levels(), strength);
+		if (model.levels.size() < model.strength)
+		{
+			cout << "INPUT ERROR: " << verifyFile << " has " << model.levels.size() << " factors, strength " << model.strength << " needs at least " << model.strength << "." << endl;
+			return 1;
+		}
+		if (constraintFile != NULL && !loadConstraints(constraintFile, model.levels, model.constraints, error))
+		{
+			cout << "INPUT ERROR: " << error << endl;
+			return 1;
+		}
+	}
+	else
+	{
+		//prompt user for desired factors and levels per factor
+		inputFactorLevels(model.levels);
+		model.reset(model.levels, strength);
+		if (model.levels.size() < model.strength)
+		{
+			cout << "INPUT ERROR: The model needs at least " << model.strength << " factors for strength " << model.strength << "." << endl;
+			return 1;
+		}
+
+		//read the combinations that may not appear together, if any were given
+		if (constraintFile != NULL && !loadConstraints(constraintFile, model.levels, model.constraints, error))
+		{
+			cout << "INPUT ERROR: " << error << endl;
+			return 1;
+		}
+	}
+
+	if (shrink > 0 && model.strength != 2)
+	{
+		cout << "INPUT ERROR: --shrink works on pairwise suites, and the model has strength " << model.strength << "." << endl;
+		return 1;
+	}
+
+	//check an existing suite instead of generating one, the exit status tells whether it covers everything
+	if (verifyFile != NULL)
+	{
+		CoverageReport report;
+		if (!generator.verify(verifyFile, model, modelFile != NULL, reportFile != NULL, report, error))
+		{
+			cout << "INPUT ERROR: " << error << endl;
+			return 1;
+		}
+		if (!outputCoverageReport(report, model, reportFile == NULL ? "" : reportFile))
+		{
+			cout << "OUTPUT ERROR: Could not write " << reportFile << "." << endl;
+			return 1;
+		}
+		return report.covered == report.required && report.invalidRows == 0 ? 0 : 2;
+	}
+
+	//an extended suite is also written with level names, so it can be extended again when the model next changes
+	string namedFile = string(outputDirectory) + "/" + model.name + ".txt";
+
+	//the rows of an existing suite are kept and only what they leave uncovered is generated
+	vector<TestCase> seedRows;
+	if (extendFile != NULL)
+	{
+		//the named suite must not land on the files it was made from
+		if (sameFile(namedFile, modelFile) || sameFile(namedFile, extendFile))
+		{
+			cout << "INPUT ERROR: The extended suite would be written over " << namedFile << ", choose another directory with --output." << endl;
+			return 1;
+		}
+		if (!loadSuiteRows(extendFile, model, seedRows, error))
+		{
+			cout << "INPUT ERROR: " << error << endl;
+			return 1;
+		}
+		options.seedRows = &seedRows;
+	}
 
 	//start counting execution time for generation of all test suites
 	auto startTime = high_resolution_clock::now();
 
-	vector<TestCase> selectedSuite = selectSuite(factorLevels);
+	//the engine named by --engine, or the default for the model, builds the suite, pairs on the bit-packed grid and higher strengths on the t-way tuple engine
+	//--stream compares fewer suites and writes the selected rows to standard output as soon as they are final
+	RowSink sink(writeToStream, &cout);
+	if (streamAttempts != 0)
+	{
+		options.attempts = streamAttempts;
+		options.sink = &sink;
+	}
+
+	TestSuite selectedSuite;
+	SuiteStats stats;
+	generator.generate(model, options, selectedSuite, stats);
 	
 	//stop counting execution time for generation of all test suites
 	auto endTime = high_resolution_clock::now();
 
-	//print total and average execution times in milliseconds
-	auto duration = duration_cast<milliseconds>(endTime - startTime);
-	cout << "Total generation time for all suites: " << duration.count() << " ms" << endl;
-	cout << "Average suite generation time: " << duration.count() / 100 << " ms" << endl;
+	//output the suite to a file named testsuite.txt and the information to the console
+	outputSuiteFile(selectedSuite);
+
+	//also write the compact binary form if asked for
+	if (binaryFile != NULL && !outputSuiteBinary(selectedSuite, model.levels, binaryFile))
+	{
+		cout << "OUTPUT ERROR: Could not write " << binaryFile << "." << endl;
+	}
+	if (extendFile != NULL && !outputModelSuite(selectedSuite, model, namedFile))
+	{
+		cout << "OUTPUT ERROR: Could not write " << namedFile << "." << endl;
+	}
+	outputSuiteAnalytics(selectedSuite, stats, model.constraints, model.strength, streamAttempts != 0);
+
+	//print total and average execution times in milliseconds, away from the streamed rows if there are any
+	//the time given to --shrink is one stage after the selection, so it is left out of the per suite average
+	ostream& console = streamAttempts != 0 ? cerr : cout;
+	long long generationMs = duration_cast<milliseconds>(endTime - startTime).count() - stats.shrinkMs;
+	console << "Total generation time for all suites: " << generationMs << " ms" << endl;
+	console << "Average suite generation time: " << generationMs / stats.attempts << " ms" << endl;
+	if (shrink > 0)
+	{
+		console << "Shrinking time: " << stats.shrinkMs << " ms" << endl;
+	}
+
+	//print the engine that built the suite, AETG when the one asked for cannot build the model
+	console << "Engine: " << generator.engineFor(model, options).name() << endl;
+
+	//print the seed so the same suite can be generated again with --seed
+	console << "Seed: " << seed << endl;
 
-	return 0;
+	return writeProfiles(profileFile, traceFile) ? 0 : 1;
 }
\ No newline at end of file
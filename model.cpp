@@ -0,0 +1,474 @@
+#include "aetg.h"
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <map>
+#include <set>
+
+using namespace std;
+using namespace std::chrono;
+
+/**
+ *
+ *	This function names a model after its file, without the
+ *  file's directory or extension.
+ *
+ *	Returns the model's name.
+ *
+ */
+static string modelName(const string& fileName)
+{
+	string baseName = fileName.substr(fileName.find_last_of('/') == string::npos ? 0 : fileName.find_last_of('/') + 1);
+	return baseName.substr(0, baseName.find_last_of('.'));
+}
+
+/**
+ *
+ *	This function reads a model from a model file, so a
+ *  model can be generated without answering prompts. One
+ *  entry per line:
+ *
+ *    factor Browser: Chrome Firefox Safari
+ *    factor Retries: 4
+ *    strength 3
+ *    forbid Browser=Safari OS=Windows
+ *    require Browser=Safari OS=macOS
+ *
+ *  A factor lists its level names after the colon, or a
+ *  single number for that many levels named 0, 1, 2 and so
+ *  on. The strength line is optional and overrides the
+ *  default. Constraints name a level as Factor=Level and
+ *  follow the rules of the constraint file, and may appear
+ *  anywhere in the file. Blank lines and lines starting
+ *  with # are ignored. The model is named after the file.
+ *
+ *	Returns true if the file was read without errors, otherwise
+ *  sets error to the first error found and returns false.
+ *
+ */
+bool loadModel(const string& fileName, Model& model, int defaultStrength, string& error)
+{
+	ifstream inputFile(fileName.c_str());
+	if (!inputFile)
+	{
+		error = string("Could not open model file ") + fileName + ".";
+		return false;
+	}
+
+	model.name = modelName(fileName);
+	model.strength = defaultStrength;
+	model.factorNames.clear();
+	model.levelNames.clear();
+	model.levels.clear();
+
+	//constraints can name any factor, so they are kept until every factor has been read
+	vector<string> constraintLines;
+	vector<int> constraintLineNumbers;
+
+	string line;
+	int lineNumber = 0;
+	while (getline(inputFile, line))
+	{
+		lineNumber++;
+		istringstream fields(line);
+		string keyword;
+		if (!(fields >> keyword) || keyword[0] == '#')
+		{
+			continue;
+		}
+
+		if (keyword == "factor")
+		{
+			string factorName;
+			string levelName;
+			vector<string> names;
+			fields >> factorName;
+			if (factorName.size() < 2 || factorName[factorName.size() - 1] != ':')
+			{
+				error = string("Line ") + to_string(lineNumber) + " of " + fileName + " should be \"factor Name: level level ...\".";
+				return false;
+			}
+			factorName.erase(factorName.size() - 1);
+			if (find(model.factorNames.begin(), model.factorNames.end(), factorName) != model.factorNames.end())
+			{
+				error = string("Factor ") + factorName + " is defined twice in " + fileName + ".";
+				return false;
+			}
+			while (fields >> levelName)
+			{
+				if (find(names.begin(), names.end(), levelName) != names.end())
+				{
+					error = string("Factor ") + factorName + " has two levels named " + levelName + " in " + fileName + ".";
+					return false;
+				}
+				names.push_back(levelName);
+			}
+
+			//a single number is a count of unnamed levels
+			if (names.size() == 1 && names[0].find_first_not_of("0123456789") == string::npos)
+			{
+				int count = atoi(names[0].c_str());
+				names.clear();
+				for (int l = 0; l < count; l++)
+				{
+					names.push_back(to_string(l));
+				}
+			}
+			if (names.empty())
+			{
+				error = string("Factor ") + factorName + " on line " + to_string(lineNumber) + " of " + fileName + " has no levels.";
+				return false;
+			}
+			model.factorNames.push_back(factorName);
+			model.levelNames.push_back(names);
+			model.levels.push_back(names.size());
+		}
+		else if (keyword == "strength")
+		{
+			if (!(fields >> model.strength) || model.strength < 2 || model.strength > 6)
+			{
+				error = string("The strength on line ") + to_string(lineNumber) + " of " + fileName + " must be between 2 and 6.";
+				return false;
+			}
+		}
+		else if (keyword == "forbid" || keyword == "require")
+		{
+			constraintLines.push_back(line);
+			constraintLineNumbers.push_back(lineNumber);
+		}
+		else
+		{
+			error = string("Unknown entry \"") + keyword + "\" on line " + to_string(lineNumber) + " of " + fileName + ".";
+			return false;
+		}
+	}
+	if (model.levels.size() < model.strength)
+	{
+		error = fileName + " needs at least " + to_string(model.strength) + " factors for strength " + to_string(model.strength) + ".";
+		return false;
+	}
+
+	//turn every Factor=Level into its component number
+	vector<int> factorBegin = factorStartingNums(model.levels);
+	model.constraints.reset(model.levels);
+	for (int i = 0; i != constraintLines.size(); i++)
+	{
+		istringstream fields(constraintLines[i]);
+		string keyword;
+		string entry;
+		vector<int> combination;
+		vector<bool> factorUsed(model.levels.size(), false);
+		fields >> keyword;
+		while (fields >> entry)
+		{
+			size_t split = entry.find('=');
+			int factor = split == string::npos ? -1 : find(model.factorNames.begin(), model.factorNames.end(), entry.substr(0, split)) - model.factorNames.begin();
+			if (factor < 0 || factor == model.factorNames.size())
+			{
+				error = entry + " on line " + to_string(constraintLineNumbers[i]) + " of " + fileName + " is not a known Factor=Level.";
+				return false;
+			}
+			const vector<string>& names = model.levelNames[factor];
+			int level = find(names.begin(), names.end(), entry.substr(split + 1)) - names.begin();
+			if (level == names.size())
+			{
+				error = string("Factor ") + model.factorNames[factor] + " has no level " + entry.substr(split + 1) + " (line " + to_string(constraintLineNumbers[i]) + " of " + fileName + ").";
+				return false;
+			}
+			if (factorUsed[factor])
+			{
+				error = string("Line ") + to_string(constraintLineNumbers[i]) + " of " + fileName + " uses two levels of factor " + model.factorNames[factor] + ".";
+				return false;
+			}
+			factorUsed[factor] = true;
+			combination.push_back(factorBegin[factor] + level);
+		}
+		if (!applyConstraint(keyword, combination, model.constraints))
+		{
+			error = string("Line ") + to_string(constraintLineNumbers[i]) + " of " + fileName + " should be \"forbid F=a G=b [H=c ...]\" or \"require F=a G=b\".";
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ *
+ *	This function finds the model files of a batch. If the
+ *  path is a directory, every file in it ending in .model
+ *  is used, in name order. Otherwise the path is a manifest
+ *  listing one model file per line, relative to the
+ *  manifest's own directory unless the path is absolute.
+ *
+ *	Returns true if the directory or manifest could be read,
+ *  otherwise sets error and returns false.
+ *
+ */
+bool listModels(const string& path, vector<string>& modelFiles, string& error)
+{
+	struct stat info;
+	if (stat(path.c_str(), &info) != 0)
+	{
+		error = string("Could not find batch ") + path + ".";
+		return false;
+	}
+
+	if (S_ISDIR(info.st_mode))
+	{
+		DIR* directory = opendir(path.c_str());
+		if (directory == NULL)
+		{
+			error = string("Could not read directory ") + path + ".";
+			return false;
+		}
+		for (dirent* entry = readdir(directory); entry != NULL; entry = readdir(directory))
+		{
+			string fileName = entry->d_name;
+			if (fileName.size() > 6 && fileName.compare(fileName.size() - 6, 6, ".model") == 0)
+			{
+				modelFiles.push_back(path + "/" + fileName);
+			}
+		}
+		closedir(directory);
+		sort(modelFiles.begin(), modelFiles.end());
+		return true;
+	}
+
+	//a manifest lists the model files, relative to where the manifest is
+	ifstream manifest(path.c_str());
+	string manifestDirectory = path.find_last_of('/') == string::npos ? "" : path.substr(0, path.find_last_of('/') + 1);
+	string line;
+	while (getline(manifest, line))
+	{
+		istringstream fields(line);
+		string fileName;
+		if (!(fields >> fileName) || fileName[0] == '#')
+		{
+			continue;
+		}
+		modelFiles.push_back(fileName[0] == '/' ? fileName : manifestDirectory + fileName);
+	}
+	return true;
+}
+
+/**
+ *
+ *	This function writes a model's suite to a file using
+ *  the model's level names. The total number of test cases
+ *  is printed on the first line followed by a blank line,
+ *  then each test case on its own line, the same layout as
+ *  testsuite.txt.
+ *
+ *	Returns true if the file could be written.
+ *
+ */
+bool outputModelSuite(TestSuite& selectedSuite, Model& model, const string& fileName)
+{
+	ofstream outputFile(fileName.c_str());
+	if (!outputFile)
+	{
+		return false;
+	}
+	vector<int> factorBegin = factorStartingNums(model.levels);
+
+	//rows end in a plain newline so the file is only flushed as its buffer fills
+	outputFile << selectedSuite.size() << "\n\n";
+	for (int i = 0; i != selectedSuite.size(); i++)
+	{
+		for (int j = 0; j != selectedSuite.factors(); j++)
+		{
+			outputFile << model.levelNames[j][selectedSuite.at(i, j) - factorBegin[j]] << " ";
+		}
+		outputFile << "\n";
+	}
+	return true;
+}
+
+/**
+ *
+ *	This function checks whether a line holds nothing but
+ *  a whole number, as the row count at the top of a suite
+ *  file does.
+ *
+ *	Returns true if the line is a single integer.
+ *
+ */
+static bool isRowCount(const string& line)
+{
+	istringstream fields(line);
+	long long count;
+	string rest;
+	return (fields >> count) && !(fields >> rest);
+}
+
+/**
+ *
+ *	This function reads an existing suite of a model, in
+ *  the layout outputModelSuite() writes, as seed rows for
+ *  extending it. Each line is a test case of level names
+ *  in factor order. A line may stop short of the model's
+ *  factors, which leaves the factors added at the end of
+ *  the model open, and a * leaves a single factor open.
+ *  Open factors are -1 in the rows. The count that
+ *  outputModelSuite() puts on the first line is not needed
+ *  and is skipped, so a first line holding a single number
+ *  is never read as a row; a file written by hand may
+ *  leave the count out.
+ *
+ *	Returns true if the file was read without errors, otherwise
+ *  sets error to the first error found and returns false.
+ *
+ */
+bool loadSuiteRows(const string& fileName, Model& model, vector<TestCase>& rows, string& error)
+{
+	ifstream inputFile(fileName.c_str());
+	if (!inputFile)
+	{
+		error = string("Could not open suite file ") + fileName + ".";
+		return false;
+	}
+	vector<int> factorBegin = factorStartingNums(model.levels);
+	int factors = model.levels.size();
+	rows.clear();
+
+	string line;
+	int lineNumber = 0;
+	while (getline(inputFile, line))
+	{
+		lineNumber++;
+		istringstream fields(line);
+		string levelName;
+		if (!(fields >> levelName) || (lineNumber == 1 && isRowCount(line)))
+		{
+			continue;
+		}
+
+		TestCase row(factors);
+		int factor = 0;
+		do
+		{
+			if (factor == factors)
+			{
+				error = string("Line ") + to_string(lineNumber) + " of " + fileName + " has more levels than the model has factors.";
+				return false;
+			}
+			if (levelName != "*")
+			{
+				const vector<string>& names = model.levelNames[factor];
+				int level = find(names.begin(), names.end(), levelName) - names.begin();
+				if (level == names.size())
+				{
+					error = string("Factor ") + model.factorNames[factor] + " has no level " + levelName + " (line " + to_string(lineNumber) + " of " + fileName + ").";
+					return false;
+				}
+				row.setComponent(factor, factorBegin[factor] + level);
+			}
+			factor++;
+		}
+		while (fields >> levelName);
+		rows.push_back(row);
+	}
+	return true;
+}
+
+/**
+ *
+ *	This function generates every model of a batch in one
+ *  process. The generator's thread pool and per-thread
+ *  workspaces (grids, counts, candidates and suites) are
+ *  shared by all models, so after the largest model
+ *  nothing is allocated again. Each suite is written to
+ *  <outputDirectory>/<model name>.txt with level names, one
+ *  line is printed per model, and the throughput of the
+ *  whole batch is printed at the end. A model that cannot
+ *  be read or written is reported and skipped. Before
+ *  anything is generated, the batch is refused if two
+ *  models would write the same suite file or a suite file
+ *  would land on a model file or the manifest.
+ *
+ *	Returns true if every model of the batch was generated.
+ *
+ */
+bool runBatch(const string& batchPath, const string& outputDirectory, int defaultStrength, GenerationOptions& options, Generator& generator)
+{
+	vector<string> modelFiles;
+	string error;
+	if (!listModels(batchPath, modelFiles, error))
+	{
+		cout << "INPUT ERROR: " << error << endl;
+		return false;
+	}
+
+	//the files the batch reads, by device and inode so any spelling of a path matches
+	set<pair<dev_t, ino_t>> inputFiles;
+	vector<string> inputPaths = modelFiles;
+	inputPaths.push_back(batchPath);
+	for (int i = 0; i != inputPaths.size(); i++)
+	{
+		struct stat info;
+		if (stat(inputPaths[i].c_str(), &info) == 0)
+		{
+			inputFiles.insert(make_pair(info.st_dev, info.st_ino));
+		}
+	}
+
+	//every suite needs a file of its own that is none of the inputs
+	map<string, string> outputOwners;
+	for (int i = 0; i != modelFiles.size(); i++)
+	{
+		string outputName = outputDirectory + "/" + modelName(modelFiles[i]) + ".txt";
+		struct stat info;
+		if (!outputOwners.insert(make_pair(outputName, modelFiles[i])).second)
+		{
+			cout << "INPUT ERROR: " << outputOwners[outputName] << " and " << modelFiles[i] << " would both be written to " << outputName << ", give the models different names." << endl;
+			return false;
+		}
+		if (stat(outputName.c_str(), &info) == 0 && inputFiles.count(make_pair(info.st_dev, info.st_ino)) != 0)
+		{
+			cout << "INPUT ERROR: The suite of " << modelFiles[i] << " would be written over " << outputName << ", choose another directory with --output." << endl;
+			return false;
+		}
+	}
+
+	Model model;
+	TestSuite selectedSuite;
+	int generated = 0;
+	long long totalCases = 0;
+	auto batchStart = high_resolution_clock::now();
+
+	for (int i = 0; i != modelFiles.size(); i++)
+	{
+		if (!loadModel(modelFiles[i], model, defaultStrength, error))
+		{
+			cout << "INPUT ERROR: " << error << endl;
+			continue;
+		}
+
+		auto startTime = high_resolution_clock::now();
+		SuiteStats stats;
+		generator.generate(model, options, selectedSuite, stats);
+		auto duration = duration_cast<milliseconds>(high_resolution_clock::now() - startTime);
+
+		string outputName = outputDirectory + "/" + model.name + ".txt";
+		if (!outputModelSuite(selectedSuite, model, outputName))
+		{
+			cout << "OUTPUT ERROR: Could not write " << outputName << "." << endl;
+			continue;
+		}
+		generated++;
+		totalCases += selectedSuite.size();
+		cout << model.name << ": " << model.levels.size() << " factors, strength " << model.strength << ", " << selectedSuite.size() << " test cases, " << duration.count() << " ms" << endl;
+	}
+
+	//print the throughput of the whole batch, from the exact time since a small batch can take under a millisecond
+	duration<double> batchDuration = high_resolution_clock::now() - batchStart;
+	cout << "********** Batch **********" << endl;
+	cout << "Models generated: " << generated << " of " << modelFiles.size() << endl;
+	cout << "Total test cases: " << totalCases << endl;
+	cout << "Total batch time: " << duration_cast<milliseconds>(batchDuration).count() << " ms" << endl;
+	cout << "Throughput: " << generated / batchDuration.count() << " models/s" << endl;
+
+	return generated == modelFiles.size();
+}
\ No newline at end of file
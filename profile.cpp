@@ -0,0 +1,260 @@
+#include "profile.h"
+#include "threadpool.h"
+#include <vector>
+#include <algorithm>
+#include <fstream>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+
+using namespace std;
+using namespace std::chrono;
+
+bool profilingEnabled()
+{
+#ifdef AETG_PROFILE
+	return true;
+#else
+	return false;
+#endif
+}
+
+#ifdef AETG_PROFILE
+
+//names of the counters and phases as they appear in the exported files
+static const char* counterNames[profileCounterCount] = { "gridProbes", "partnerProbes", "levelTies", "candidateTies", "constraintRejects", "candidates", "rows" };
+static const char* phaseNames[profilePhaseCount] = { "firstCase", "seedRows", "candidates", "buildAround", "addToSuite", "worklist", "selection" };
+
+//phase spans kept for the trace in total, beyond this only the per-attempt totals grow
+static const long long maxTraceEvents = 1 << 20;
+
+//one timed phase span of an attempt
+struct ProfileEvent
+{
+	int phase;
+	int64_t start;
+	int64_t duration;
+};
+
+//everything recorded about one suite attempt
+struct AttemptRecord
+{
+	int attempt;
+	int thread;
+	int64_t start;
+	int64_t end;
+	int64_t phaseTime[profilePhaseCount];
+	vector<int> rowGains;
+	vector<ProfileEvent> events;
+};
+
+thread_local ProfileThread profileThread;
+static thread_local AttemptRecord* currentAttempt = NULL;
+
+//the threads that have counted something, and the finished attempts
+static mutex profileMutex;
+static vector<ProfileThread*> profileThreads;
+static vector<AttemptRecord*> finishedAttempts;
+static atomic<long long> traceEvents(0);
+static const steady_clock::time_point profileOrigin = steady_clock::now();
+
+/**
+ *
+ *	This function reads the clock used by every record.
+ *
+ *	Returns the nanoseconds since the program started.
+ *
+ */
+static int64_t profileNow()
+{
+	return duration_cast<nanoseconds>(steady_clock::now() - profileOrigin).count();
+}
+
+void registerProfileThread(ProfileThread& thread)
+{
+	lock_guard<mutex> lock(profileMutex);
+	thread.registered = true;
+	profileThreads.push_back(&thread);
+}
+
+void profileRow(int newPairs)
+{
+	profileCount(counterRows, 1);
+	if (currentAttempt != NULL)
+	{
+		currentAttempt->rowGains.push_back(newPairs);
+	}
+}
+
+//a thread waiting on a loop inside its attempt may run another attempt, so the outer one is put back afterwards
+ProfileAttempt::ProfileAttempt(int attempt)
+{
+	record = new AttemptRecord();
+	record->attempt = attempt;
+	record->thread = ThreadPool::currentSlot();
+	record->start = profileNow();
+	record->end = record->start;
+	outer = currentAttempt;
+	currentAttempt = record;
+}
+
+ProfileAttempt::~ProfileAttempt()
+{
+	record->end = profileNow();
+	currentAttempt = outer;
+	lock_guard<mutex> lock(profileMutex);
+	finishedAttempts.push_back(record);
+}
+
+ProfileScope::ProfileScope(ProfilePhase scopePhase)
+{
+	phase = scopePhase;
+	start = profileNow();
+}
+
+ProfileScope::~ProfileScope()
+{
+	//phases outside an attempt (a candidate built by a helper thread) are not timed
+	if (currentAttempt == NULL)
+	{
+		return;
+	}
+	int64_t duration = profileNow() - start;
+	currentAttempt->phaseTime[phase] += duration;
+	if (traceEvents++ < maxTraceEvents)
+	{
+		ProfileEvent event = { phase, start, duration };
+		currentAttempt->events.push_back(event);
+	}
+}
+
+void resetProfile()
+{
+	lock_guard<mutex> lock(profileMutex);
+	for (int t = 0; t != profileThreads.size(); t++)
+	{
+		fill(profileThreads[t]->counters, profileThreads[t]->counters + profileCounterCount, 0);
+	}
+	for (int a = 0; a != finishedAttempts.size(); a++)
+	{
+		delete finishedAttempts[a];
+	}
+	finishedAttempts.clear();
+	traceEvents = 0;
+}
+
+/**
+ *
+ *	This function writes every counter, summed over the
+ *  threads and for each thread, then one line per attempt
+ *  with its thread, wall time, time per phase and the new
+ *  pairs (or tuples) of each row it added, in order.
+ *  Times are in microseconds.
+ *
+ *	Returns true if the file could be written.
+ *
+ */
+bool writeProfileJson(const string&)
+{
+	ofstream json(fileName.c_str());
+	if (!json)
+	{
+		return false;
+	}
+	lock_guard<mutex> lock(profileMutex);
+
+	json << "{\n  \"counters\": {";
+	for (int c = 0; c != profileCounterCount; c++)
+	{
+		uint64_t total = 0;
+		for (int t = 0; t != profileThreads.size(); t++)
+		{
+			total += profileThreads[t]->counters[c];
+		}
+		json << (c == 0 ? " " : ", ") << "\"" << counterNames[c] << "\": " << total;
+	}
+	json << " },\n  \"threads\": [\n";
+	for (int t = 0; t != profileThreads.size(); t++)
+	{
+		json << "    {";
+		for (int c = 0; c != profileCounterCount; c++)
+		{
+			json << (c == 0 ? " " : ", ") << "\"" << counterNames[c] << "\": " << profileThreads[t]->counters[c];
+		}
+		json << " }" << (t + 1 != profileThreads.size() ? "," : "") << "\n";
+	}
+
+	//one attempt per line so the file is easy to diff and grep
+	json << "  ],\n  \"attempts\": [\n";
+	for (int a = 0; a != finishedAttempts.size(); a++)
+	{
+		AttemptRecord& record = *finishedAttempts[a];
+		json << "    { \"attempt\": " << record.attempt << ", \"thread\": " << record.thread << ", \"wallUs\": " << (record.end - record.start) / 1000 << ", \"phasesUs\": {";
+		for (int p = 0; p != profilePhaseCount; p++)
+		{
+			json << (p == 0 ? " " : ", ") << "\"" << phaseNames[p] << "\": " << record.phaseTime[p] / 1000;
+		}
+		json << " }, \"rows\": " << record.rowGains.size() << ", \"newPairsPerRow\": [";
+		for (int r = 0; r != record.rowGains.size(); r++)
+		{
+			json << (r == 0 ? "" : ", ") << record.rowGains[r];
+		}
+		json << "] }" << (a + 1 != finishedAttempts.size() ? "," : "") << "\n";
+	}
+	json << "  ]\n}\n";
+	return true;
+}
+
+/**
+ *
+ *	This function writes the attempts and their phase spans
+ *  as complete ("X") trace events, one track per pool slot,
+ *  with the rows of each attempt as an argument. Times are
+ *  in microseconds as the format expects.
+ *
+ *	Returns true if the file could be written.
+ *
+ */
+bool writeProfileTrace(const string&)
+{
+	ofstream trace(fileName.c_str());
+	if (!trace)
+	{
+		return false;
+	}
+	lock_guard<mutex> lock(profileMutex);
+
+	trace << "{\"traceEvents\": [\n";
+	bool first = true;
+	for (int a = 0; a != finishedAttempts.size(); a++)
+	{
+		AttemptRecord& record = *finishedAttempts[a];
+		trace << (first ? "" : ",\n") << "{\"name\": \"attempt " << record.attempt << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << record.thread << ", \"ts\": " << record.start / 1000.0 << ", \"dur\": " << (record.end - record.start) / 1000.0 << ", \"args\": {\"rows\": " << record.rowGains.size() << "}}";
+		first = false;
+		for (int e = 0; e != record.events.size(); e++)
+		{
+			ProfileEvent& event = record.events[e];
+			trace << ",\n{\"name\": \"" << phaseNames[event.phase] << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << record.thread << ", \"ts\": " << event.start / 1000.0 << ", \"dur\": " << event.duration / 1000.0 << "}";
+		}
+	}
+	trace << "\n]}\n";
+	return true;
+}
+
+#else
+
+void resetProfile()
+{
+}
+
+bool writeProfileJson(const string&)
+{
+	return false;
+}
+
+bool writeProfileTrace(const string&)
+{
+	return false;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,128 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+/**
+ *
+ *  Instrumentation of the generation hot paths. Built with
+ *  -DAETG_PROFILE, the AETG_* macros below count grid
+ *  probes, tie pools and candidates per thread, time the
+ *  phases of every suite attempt and record the new pairs
+ *  (or tuples) of every row added, which is the coverage
+ *  curve of the attempt. Without the flag every macro
+ *  expands to nothing, so a normal build carries no
+ *  instrumentation code in its hot loops at all.
+ *
+ *  writeProfileJson() writes the counters and the attempts
+ *  as JSON, and writeProfileTrace() writes the attempts and
+ *  their phases in the trace event format that chrome://tracing
+ *  and Perfetto read. Both return false in a build without
+ *  the flag. Counters are kept per thread and are read when
+ *  exporting, so export while the threads that generated
+ *  (the generator's pool) still exist.
+ *
+ */
+
+//what the hot paths count, per thread
+enum ProfileCounter
+{
+	counterGridProbes,
+	counterPartnerProbes,
+	counterLevelTies,
+	counterCandidateTies,
+	counterConstraintRejects,
+	counterCandidates,
+	counterRows,
+	profileCounterCount
+};
+
+//the phases of building one suite, timed in every attempt
+enum ProfilePhase
+{
+	phaseFirstCase,
+	phaseSeedRows,
+	phaseCandidates,
+	phaseBuildAround,
+	phaseAddToSuite,
+	phaseWorklist,
+	phaseSelection,
+	profilePhaseCount
+};
+
+//returns true if this build records anything (built with -DAETG_PROFILE)
+bool profilingEnabled();
+
+//drops everything recorded so far
+void resetProfile();
+
+//writes the counters and every attempt's phases and coverage curve as JSON
+bool writeProfileJson(const std::string& fileName);
+
+//writes the attempts and their phases as trace events
+bool writeProfileTrace(const std::string& fileName);
+
+#ifdef AETG_PROFILE
+
+//the counters of one thread, registered with the exporter the first time the thread counts anything
+struct ProfileThread
+{
+	uint64_t counters[profileCounterCount];
+	bool registered;
+};
+
+extern thread_local ProfileThread profileThread;
+void registerProfileThread(ProfileThread& thread);
+
+//adds to one of the calling thread's counters
+inline void profileCount(ProfileCounter counter, uint64_t amount)
+{
+	ProfileThread& thread = profileThread;
+	if (!thread.registered)
+	{
+		registerProfileThread(thread);
+	}
+	thread.counters[counter] += amount;
+}
+
+//records a row added to the calling thread's attempt and the new pairs (or tuples) it covered
+void profileRow(int newPairs);
+
+struct AttemptRecord;
+
+//times one suite attempt on the calling thread, from construction to destruction
+class ProfileAttempt
+{
+private:
+	AttemptRecord* record;
+	AttemptRecord* outer;
+public:
+	ProfileAttempt(int attempt);
+	~ProfileAttempt();
+};
+
+//times one phase of the calling thread's attempt, from construction to destruction
+class ProfileScope
+{
+private:
+	ProfilePhase phase;
+	int64_t start;
+public:
+	ProfileScope(ProfilePhase scopePhase);
+	~ProfileScope();
+};
+
+#define AETG_PROFILE_JOIN2(a, b) a##b
+#define AETG_PROFILE_JOIN(a, b) AETG_PROFILE_JOIN2(a, b)
+#define AETG_COUNT(counter, amount) profileCount(counter, amount)
+#define AETG_ROW(newPairs) profileRow(newPairs)
+#define AETG_ATTEMPT(attempt) ProfileAttempt AETG_PROFILE_JOIN(profileAttempt, __LINE__)(attempt)
+#define AETG_PHASE(phase) ProfileScope AETG_PROFILE_JOIN(profileScope, __LINE__)(phase)
+
+#else
+
+#define AETG_COUNT(counter, amount)
+#define AETG_ROW(newPairs)
+#define AETG_ATTEMPT(attempt)
+#define AETG_PHASE(phase)
+
+#endif
\ No newline at end of file
@@ -0,0 +1,267 @@
+#include "aetgfunctions.h"
+
+using namespace std;
+
+//the highest coverage strength supported, keeps the per-tuple arrays on the stack
+static const int maxStrength = 6;
+
+//how many earlier rows a sparse row is compared with when looking for a row to merge into
+static const int mergeWindow = 256;
+
+/**
+ *
+ *	This function calls body(index, subset) for every
+ *  t-way tuple of a suite row, with the tuple's index in
+ *  the indexer's numbering and its sorted factors. The body
+ *  returns false to stop early.
+ *
+ *	Returns false if the body stopped early.
+ *
+ */
+template <typename Body>
+static bool forEachTuple(const TestSuite& suite, int row, const vector<int>& factorBegin, const TupleCoverage& indexer, const Body& body)
+{
+	int strength = indexer.getStrength();
+	int factors = suite.factors();
+	int subset[maxStrength];
+	int tupleLevels[maxStrength];
+	for (int i = 0; i != strength; i++)
+	{
+		subset[i] = i;
+	}
+
+	//walk every t-subset of the factors in lexicographic order
+	while (true)
+	{
+		for (int i = 0; i != strength; i++)
+		{
+			tupleLevels[i] = suite.at(row, subset[i]) - factorBegin[subset[i]];
+		}
+		if (!body(indexer.tupleIndex(subset, tupleLevels), subset))
+		{
+			return false;
+		}
+
+		int i = strength - 1;
+		while (i >= 0 && subset[i] == factors - strength + i)
+		{
+			i--;
+		}
+		if (i < 0)
+		{
+			return true;
+		}
+		subset[i]++;
+		for (int j = i + 1; j != strength; j++)
+		{
+			subset[j] = subset[j - 1] + 1;
+		}
+	}
+}
+
+/**
+ *
+ *	This function marks the factors of a row that take part
+ *  in a tuple no other row covers. Only those positions
+ *  have to keep their level; the others are "don't care".
+ *
+ *	Returns no value(s), the row's words of needed are filled in.
+ *
+ */
+static void markNeeded(const TestSuite& suite, int row, const vector<int>& factorBegin, const TupleCoverage& indexer, const vector<uint32_t>& counts, uint64_t* needed)
+{
+	int words = (suite.factors() + 63) / 64;
+	int strength = indexer.getStrength();
+	fill(needed, needed + words, 0);
+	forEachTuple(suite, row, factorBegin, indexer, [&](uint64_t index, const int* subset)
+	{
+		if (counts[index] == 1)
+		{
+			for (int i = 0; i != strength; i++)
+			{
+				needed[subset[i] >> 6] |= (uint64_t)1 << (subset[i] & 63);
+			}
+		}
+		return true;
+	});
+}
+
+/**
+ *
+ *	This function checks that two rows agree on every
+ *  factor that both of them need.
+ *
+ *	Returns true if the rows can be merged into one.
+ *
+ */
+static bool neededAgree(const TestSuite& suite, int first, int second, const uint64_t* firstNeeded, const uint64_t* secondNeeded, int words)
+{
+	for (int w = 0; w != words; w++)
+	{
+		for (uint64_t both = firstNeeded[w] & secondNeeded[w]; both != 0; both &= both - 1)
+		{
+			int f = w * 64 + __builtin_ctzll(both);
+			if (suite.at(first, f) != suite.at(second, f))
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+/**
+ *
+ *	This function shrinks a finished suite without losing
+ *  any tuple it covers. Every t-way tuple of the model gets
+ *  a count of the rows covering it, then two passes run:
+ *
+ *  Rows whose tuples are all covered at least twice are
+ *  dropped, starting from the last row, since the last
+ *  rows of a greedy suite cover the fewest new tuples.
+ *
+ *  A row's needed factors are those in a tuple no other row
+ *  covers, the rest are "don't care". Starting again from
+ *  the end, each row needing at most half of its factors
+ *  is compared with up to 256 earlier rows. If some row
+ *  agrees with it on every factor both need, the two are
+ *  merged into that earlier row (needed levels from either,
+ *  the earlier row's levels elsewhere) and the later row
+ *  is dropped. Merged rows must satisfy the constraints.
+ *  The first fixedRows rows (rows kept from an existing
+ *  suite) are never dropped or changed.
+ *
+ *  Each row is looked at a bounded number of times and
+ *  every look walks the C(factors, t) tuples of the row,
+ *  so suites of 100k rows are reduced in seconds.
+ *
+ *	Returns the number of rows removed.
+ *
+ */
+int reduceSuite(TestSuite& suite, vector<int>& levels, int strength, ConstraintSet& constraints, int fixedRows)
+{
+	int rows = suite.size();
+	int factors = suite.factors();
+	if (rows == fixedRows || factors < strength)
+	{
+		return 0;
+	}
+	vector<int> factorBegin = factorStartingNums(levels);
+	TupleCoverage indexer;
+	indexer.reset(levels, strength);
+
+	//how many rows cover each tuple
+	vector<uint32_t> counts(indexer.tupleCount(), 0);
+	auto countUp = [&](uint64_t index, const int*)
+	{
+		counts[index]++;
+		return true;
+	};
+	auto countDown = [&](uint64_t index, const int*)
+	{
+		counts[index]--;
+		return true;
+	};
+	for (int r = 0; r != rows; r++)
+	{
+		forEachTuple(suite, r, factorBegin, indexer, countUp);
+	}
+
+	//drop every row whose tuples are all covered by other rows
+	vector<bool> removed(rows, false);
+	int removedRows = 0;
+	for (int r = rows - 1; r >= fixedRows; r--)
+	{
+		bool redundant = forEachTuple(suite, r, factorBegin, indexer, [&](uint64_t index, const int*)
+		{
+			return counts[index] >= 2;
+		});
+		if (redundant)
+		{
+			forEachTuple(suite, r, factorBegin, indexer, countDown);
+			removed[r] = true;
+			removedRows++;
+		}
+	}
+
+	//the needed factors of every row, refreshed for a row just before it is merged since counts keep changing
+	int words = (factors + 63) / 64;
+	vector<uint64_t> needed((size_t)rows * words);
+	for (int r = 0; r != rows; r++)
+	{
+		if (!removed[r])
+		{
+			markNeeded(suite, r, factorBegin, indexer, counts, &needed[(size_t)r * words]);
+		}
+	}
+
+	//merge sparse rows into earlier rows they agree with
+	TestCase mergedCase;
+	for (int later = rows - 1; later > fixedRows; later--)
+	{
+		if (removed[later])
+		{
+			continue;
+		}
+		uint64_t* laterNeeded = &needed[(size_t)later * words];
+		markNeeded(suite, later, factorBegin, indexer, counts, laterNeeded);
+		int neededFactors = 0;
+		for (int w = 0; w != words; w++)
+		{
+			neededFactors += __builtin_popcountll(laterNeeded[w]);
+		}
+		if (neededFactors * 2 > factors)
+		{
+			continue;
+		}
+
+		int compared = 0;
+		for (int earlier = later - 1; earlier >= fixedRows && compared != mergeWindow; earlier--)
+		{
+			if (removed[earlier])
+			{
+				continue;
+			}
+			compared++;
+
+			//the stored needed factors may be stale, so a match is checked again with fresh ones
+			uint64_t* earlierNeeded = &needed[(size_t)earlier * words];
+			if (!neededAgree(suite, earlier, later, earlierNeeded, laterNeeded, words))
+			{
+				continue;
+			}
+			markNeeded(suite, earlier, factorBegin, indexer, counts, earlierNeeded);
+			if (!neededAgree(suite, earlier, later, earlierNeeded, laterNeeded, words))
+			{
+				continue;
+			}
+
+			//the merged row takes what the later row needs and keeps the earlier row's levels elsewhere
+			mergedCase.reset(factors);
+			for (int f = 0; f != factors; f++)
+			{
+				bool laterNeeds = (laterNeeded[f >> 6] >> (f & 63)) & 1;
+				mergedCase.setComponent(f, laterNeeds ? suite.at(later, f) : suite.at(earlier, f));
+			}
+			if (!constraints.empty() && !constraints.allowsTestCase(mergedCase))
+			{
+				continue;
+			}
+
+			forEachTuple(suite, earlier, factorBegin, indexer, countDown);
+			forEachTuple(suite, later, factorBegin, indexer, countDown);
+			for (int f = 0; f != factors; f++)
+			{
+				suite.setAt(earlier, f, mergedCase.atIndex(f));
+			}
+			forEachTuple(suite, earlier, factorBegin, indexer, countUp);
+			markNeeded(suite, earlier, factorBegin, indexer, counts, earlierNeeded);
+			removed[later] = true;
+			removedRows++;
+			break;
+		}
+	}
+
+	suite.removeRows(removed);
+	return removedRows;
+}
\ No newline at end of file
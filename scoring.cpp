@@ -0,0 +1,299 @@
+#include "aetgfunctions.h"
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define AETG_X86_KERNELS 1
+#endif
+
+using namespace std;
+
+//signature shared by every scoring kernel
+typedef void (*ScoreKernel)(const uint64_t* rows, int levels, int rowWords, const uint64_t* selected, int* scores);
+
+//rows of up to this many words are scored by a kernel built for their exact width
+static const int maxNarrowWords = 2;
+
+/**
+ *
+ *	This function counts the set bits in a 64-bit word.
+ *  It is only used by the scalar kernel and compiles to a
+ *  single instruction where the compiler supports it.
+ *
+ *	Returns the number of set bits.
+ *
+ */
+static inline int popcount64(uint64_t word)
+{
+#if defined(__GNUC__)
+	return __builtin_popcountll(word);
+#else
+	word = word - ((word >> 1) & 0x5555555555555555ull);
+	word = (word & 0x3333333333333333ull) + ((word >> 2) & 0x3333333333333333ull);
+	word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+	return (int)((word * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+/**
+ *
+ *	This function is the portable scoring kernel. Each
+ *  level's row of uncovered pairs is ANDed with the mask
+ *  of components already selected in the test case and
+ *  the set bits are counted, one word at a time.
+ *
+ *	Returns no value(s).
+ *
+ */
+static void scoreLevelsScalar(const uint64_t* rows, int levels, int rowWords, const uint64_t* selected, int* scores)
+{
+	for (int l = 0; l != levels; l++)
+	{
+		const uint64_t* currentRow = rows + (size_t)l * rowWords;
+		int count = 0;
+		for (int w = 0; w != rowWords; w++)
+		{
+			count += popcount64(currentRow[w] & selected[w]);
+		}
+		scores[l] = count;
+	}
+}
+
+#ifdef AETG_X86_KERNELS
+/**
+ *
+ *	This function is the kernel for rows of exactly
+ *  RowWords words (a model of at most 64 x RowWords
+ *  components), used with the vector kernels since every
+ *  processor that has them has the popcount instruction
+ *  too. Rows this short do not pay for loading, counting
+ *  and summing a vector register, and with the width known
+ *  at compile time the word loop is unrolled and the rows
+ *  are indexed without a multiplication.
+ *
+ *	Returns no value(s).
+ *
+ */
+template <int RowWords>
+__attribute__((target("popcnt")))
+static void scoreLevelsNarrowPopcnt(const uint64_t* rows, int levels, int, const uint64_t* selected, int* scores)
+{
+	for (int l = 0; l != levels; l++)
+	{
+		int count = 0;
+		for (int w = 0; w != RowWords; w++)
+		{
+			count += (int)_mm_popcnt_u64(rows[l * RowWords + w] & selected[w]);
+		}
+		scores[l] = count;
+	}
+}
+
+/**
+ *
+ *	This function is the AVX2 scoring kernel. AVX2 has no
+ *  popcount instruction, so the bytes of four words at a
+ *  time are counted with a nibble lookup table (vpshufb)
+ *  and summed with vpsadbw. The leftover words of each row
+ *  are counted with the scalar instruction.
+ *
+ *	Returns no value(s).
+ *
+ */
+__attribute__((target("avx2,popcnt")))
+static void scoreLevelsAvx2(const uint64_t* rows, int levels, int rowWords, const uint64_t* selected, int* scores)
+{
+	const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+		0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+	const __m256i lowNibbles = _mm256_set1_epi8(0x0F);
+	int vectorWords = rowWords & ~3;
+
+	for (int l = 0; l != levels; l++)
+	{
+		const uint64_t* currentRow = rows + (size_t)l * rowWords;
+		__m256i total = _mm256_setzero_si256();
+		for (int w = 0; w != vectorWords; w += 4)
+		{
+			__m256i bits = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(currentRow + w)), _mm256_loadu_si256((const __m256i*)(selected + w)));
+			__m256i low = _mm256_shuffle_epi8(lookup, _mm256_and_si256(bits, lowNibbles));
+			__m256i high = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(bits, 4), lowNibbles));
+			total = _mm256_add_epi64(total, _mm256_sad_epu8(_mm256_add_epi8(low, high), _mm256_setzero_si256()));
+		}
+		int count = (int)(_mm256_extract_epi64(total, 0) + _mm256_extract_epi64(total, 1) + _mm256_extract_epi64(total, 2) + _mm256_extract_epi64(total, 3));
+		for (int w = vectorWords; w != rowWords; w++)
+		{
+			count += (int)_mm_popcnt_u64(currentRow[w] & selected[w]);
+		}
+		scores[l] = count;
+	}
+}
+
+/**
+ *
+ *	This function is the AVX-512 scoring kernel. Eight words
+ *  are ANDed and counted per instruction with VPOPCNTQ, and
+ *  the tail of each row uses a masked load so no scalar
+ *  loop is needed.
+ *
+ *	Returns no value(s).
+ *
+ */
+__attribute__((target("avx512f,avx512vpopcntdq")))
+static void scoreLevelsAvx512(const uint64_t* rows, int levels, int rowWords, const uint64_t* selected, int* scores)
+{
+	int vectorWords = rowWords & ~7;
+	__mmask8 tailMask = (__mmask8)((1u << (rowWords & 7)) - 1);
+
+	for (int l = 0; l != levels; l++)
+	{
+		const uint64_t* currentRow = rows + (size_t)l * rowWords;
+		__m512i total = _mm512_setzero_si512();
+		for (int w = 0; w != vectorWords; w += 8)
+		{
+			__m512i bits = _mm512_and_si512(_mm512_loadu_si512(currentRow + w), _mm512_loadu_si512(selected + w));
+			total = _mm512_add_epi64(total, _mm512_popcnt_epi64(bits));
+		}
+		if (tailMask != 0)
+		{
+			__m512i bits = _mm512_and_si512(_mm512_maskz_loadu_epi64(tailMask, currentRow + vectorWords), _mm512_maskz_loadu_epi64(tailMask, selected + vectorWords));
+			total = _mm512_add_epi64(total, _mm512_popcnt_epi64(bits));
+		}
+		//summed by hand with zero-masked extracts, the plain ones (and _mm512_reduce_add_epi64()) set off -Wmaybe-uninitialized in GCC 12
+		__m256i halves = _mm256_add_epi64(_mm512_maskz_extracti64x4_epi64(0xFF, total, 0), _mm512_maskz_extracti64x4_epi64(0xFF, total, 1));
+		scores[l] = (int)(_mm256_extract_epi64(halves, 0) + _mm256_extract_epi64(halves, 1) + _mm256_extract_epi64(halves, 2) + _mm256_extract_epi64(halves, 3));
+	}
+}
+#endif
+
+/**
+ *
+ *	This data structure pairs each kernel with the name
+ *  used to report or force it, and with the kernels it
+ *  uses for rows of one to maxNarrowWords words.
+ *  The list is ordered from most to least preferred.
+ *
+ */
+struct KernelChoice
+{
+	const char* name;
+	ScoreKernel kernel;
+	ScoreKernel narrow[maxNarrowWords];
+};
+
+static const KernelChoice kernelChoices[] = {
+#ifdef AETG_X86_KERNELS
+	{ "avx512", scoreLevelsAvx512, { scoreLevelsNarrowPopcnt<1>, scoreLevelsNarrowPopcnt<2> } },
+	{ "avx2", scoreLevelsAvx2, { scoreLevelsNarrowPopcnt<1>, scoreLevelsNarrowPopcnt<2> } },
+#endif
+	//without the popcount instruction an unrolled row is no faster than the loop
+	{ "scalar", scoreLevelsScalar, { scoreLevelsScalar, scoreLevelsScalar } },
+};
+
+/**
+ *
+ *	This function checks whether the running processor
+ *  supports the named kernel.
+ *
+ *	Returns true if the kernel can be used.
+ *
+ */
+static bool kernelSupported(const char* name)
+{
+#ifdef AETG_X86_KERNELS
+	__builtin_cpu_init();
+	if (strcmp(name, "avx512") == 0)
+	{
+		return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vpopcntdq");
+	}
+	if (strcmp(name, "avx2") == 0)
+	{
+		return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+	}
+#endif
+	return strcmp(name, "scalar") == 0;
+}
+
+/**
+ *
+ *	This function picks the most preferred kernel that the
+ *  running processor supports. It runs once, while the
+ *  program's statics are initialised.
+ *
+ *	Returns the index of the selected kernel.
+ *
+ */
+static int detectKernel()
+{
+	int choices = sizeof(kernelChoices) / sizeof(kernelChoices[0]);
+	for (int i = 0; i != choices; i++)
+	{
+		if (kernelSupported(kernelChoices[i].name))
+		{
+			return i;
+		}
+	}
+	return choices - 1;
+}
+
+static int activeKernel = detectKernel();
+
+/**
+ *
+ *	This function scores every level of a factor against a
+ *  partial test case in one pass. rows points at the grid
+ *  rows of the factor's first component (the factor's rows
+ *  are contiguous) and selected is a bitmask of the
+ *  components already in the test case. scores[l] receives
+ *  the number of new pairs level l would form, exactly what
+ *  probing the grid pair by pair would count. Rows of up
+ *  to maxNarrowWords words go to the active kernel's
+ *  kernel for their exact width.
+ *
+ *	Returns no value(s).
+ *
+ */
+void scoreLevels(const uint64_t* rows, int levels, int rowWords, const uint64_t* selected, int* scores)
+{
+	const KernelChoice& choice = kernelChoices[activeKernel];
+	if (rowWords != 0 && rowWords <= maxNarrowWords)
+	{
+		choice.narrow[rowWords - 1](rows, levels, rowWords, selected, scores);
+		return;
+	}
+	choice.kernel(rows, levels, rowWords, selected, scores);
+}
+
+/**
+ *
+ *	This function reports which scoring kernel is in use.
+ *
+ *	Returns the kernel's name ("avx512", "avx2" or "scalar").
+ *
+ */
+const char* scoringKernelName()
+{
+	return kernelChoices[activeKernel].name;
+}
+
+/**
+ *
+ *	This function forces a scoring kernel by name, for
+ *  example to compare the vector kernels with the scalar
+ *  one. Kernels the processor does not support are refused.
+ *
+ *	Returns true if the kernel was selected.
+ *
+ */
+bool setScoringKernel(const char* name)
+{
+	int choices = sizeof(kernelChoices) / sizeof(kernelChoices[0]);
+	for (int i = 0; i != choices; i++)
+	{
+		if (strcmp(kernelChoices[i].name, name) == 0 && kernelSupported(name))
+		{
+			activeKernel = i;
+			return true;
+		}
+	}
+	return false;
+}
\ No newline at end of file
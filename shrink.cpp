@@ -0,0 +1,402 @@
+#include "aetgfunctions.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include "threadpool.h"
+
+using namespace std;
+using namespace std::chrono;
+
+//moves a chain makes between looks at the clock and at the other chains, and between cooling steps
+static const int movesPerCheck = 1024;
+
+//annealing temperature a chain starts at, its cooling per check, and the floor at which it is reheated
+static const double startTemperature = 0.3;
+static const double coolingRate = 0.95;
+static const double finalTemperature = 0.02;
+
+//count given to pairs the starting suite does not cover (impossible under the constraints), so they never count as missing
+static const uint32_t ignoredPair = 1u << 30;
+
+//the pair counts of all chains together are kept below this many bytes, fewer chains run otherwise
+static const size_t maxCountBytes = (size_t)1 << 30;
+
+//the random streams of the chains start here, away from the streams of the suite attempts
+static const uint64_t shrinkStreams = 0x5348524B00000000ull;
+
+/**
+ *
+ *  This class is one annealing chain: a copy of the suite
+ *  with one row removed, how many rows cover every pair,
+ *  and the list of pairs no row covers. A move changes one
+ *  cell, and its effect on the number of uncovered pairs is
+ *  found from the counts of the pairs the cell takes part
+ *  in, without recounting the suite.
+ *
+ */
+class ShrinkChain
+{
+private:
+	vector<TestCase> rows;
+	vector<uint32_t> counts;
+	vector<int> uncovered;
+	vector<int> uncoveredSlot;
+	const vector<size_t>* pairStart;
+	const vector<int>* componentFactor;
+	int components;
+
+	//returns the index of a pair of components from different factors in the counts
+	size_t pairIndex(int first, int second) const
+	{
+		if (first > second)
+		{
+			swap(first, second);
+		}
+		return (*pairStart)[first] + second - first - 1;
+	}
+
+	//counts one more row covering the pair
+	void addPair(int first, int second)
+	{
+		size_t index = pairIndex(first, second);
+		if (counts[index] == 0)
+		{
+			//swap the last uncovered pair into this one's slot
+			int slot = uncoveredSlot[index];
+			int last = uncovered.back();
+			uncovered[slot] = last;
+			uncoveredSlot[pairIndex(last / components, last % components)] = slot;
+			uncovered.pop_back();
+			uncoveredSlot[index] = -1;
+		}
+		counts[index]++;
+	}
+
+	//counts one fewer row covering the pair
+	void removePair(int first, int second)
+	{
+		size_t index = pairIndex(first, second);
+		if (--counts[index] == 0)
+		{
+			uncoveredSlot[index] = uncovered.size();
+			uncovered.push_back(min(first, second) * components + max(first, second));
+		}
+	}
+public:
+	ShrinkChain()
+	{
+		pairStart = NULL;
+		componentFactor = NULL;
+		components = 0;
+	}
+
+	//returns the rows of the chain
+	const vector<TestCase>& suiteRows() const
+	{
+		return rows;
+	}
+
+	/**
+	 *
+	 *	This function starts the chain from a suite that
+	 *  covers every pair it can: the counts are taken, the
+	 *  pairs no row covers are set aside as impossible, and
+	 *  the row covering the fewest pairs on its own is
+	 *  removed (ties broken at random, so the chains start
+	 *  apart). The first fixedRows rows are never removed.
+	 *
+	 *	Returns no value(s).
+	 *
+	 */
+	void load(const vector<TestCase>& suite, const vector<size_t>& starts, const vector<int>& factorOf, int fixedRows, RandomStream& rng)
+	{
+		pairStart = &starts;
+		componentFactor = &factorOf;
+		components = factorOf.size();
+		rows = suite;
+		size_t pairs = starts.empty() ? 0 : starts.back();
+		counts.assign(pairs, 0);
+		uncoveredSlot.assign(pairs, -1);
+		uncovered.clear();
+		int factors = rows[0].testSize();
+		for (int r = 0; r != rows.size(); r++)
+		{
+			for (int f = 0; f != factors; f++)
+			{
+				for (int g = f + 1; g != factors; g++)
+				{
+					counts[pairIndex(rows[r].atIndex(f), rows[r].atIndex(g))]++;
+				}
+			}
+		}
+		for (size_t p = 0; p != pairs; p++)
+		{
+			if (counts[p] == 0)
+			{
+				counts[p] = ignoredPair;
+			}
+		}
+
+		//the row with the fewest pairs only it covers leaves the least to repair
+		int removed = -1;
+		int fewest = 0;
+		int ties = 0;
+		for (int r = fixedRows; r != rows.size(); r++)
+		{
+			int unique = 0;
+			for (int f = 0; f != factors; f++)
+			{
+				for (int g = f + 1; g != factors; g++)
+				{
+					unique += counts[pairIndex(rows[r].atIndex(f), rows[r].atIndex(g))] == 1;
+				}
+			}
+			if (removed < 0 || unique < fewest)
+			{
+				removed = r;
+				fewest = unique;
+				ties = 1;
+			}
+			else if (unique == fewest && rng.below(++ties) == 0)
+			{
+				removed = r;
+			}
+		}
+		for (int f = 0; f != factors; f++)
+		{
+			for (int g = f + 1; g != factors; g++)
+			{
+				removePair(rows[removed].atIndex(f), rows[removed].atIndex(g));
+			}
+		}
+		rows.erase(rows.begin() + removed);
+	}
+
+	/**
+	 *
+	 *	This function works out how the number of uncovered
+	 *  pairs changes if a cell of a row is given a component.
+	 *
+	 *	Returns the change, negative if the move covers more than it uncovers.
+	 *
+	 */
+	int moveDelta(int row, int factor, int component) const
+	{
+		const TestCase& testCase = rows[row];
+		int old = testCase.atIndex(factor);
+		int delta = 0;
+		for (int f = 0; f != testCase.testSize(); f++)
+		{
+			if (f != factor)
+			{
+				delta += counts[pairIndex(old, testCase.atIndex(f))] == 1;
+				delta -= counts[pairIndex(component, testCase.atIndex(f))] == 0;
+			}
+		}
+		return delta;
+	}
+
+	//gives a cell of a row a new component and updates the counts of every pair it leaves and joins
+	void applyMove(int row, int factor, int component)
+	{
+		TestCase& testCase = rows[row];
+		int old = testCase.atIndex(factor);
+		for (int f = 0; f != testCase.testSize(); f++)
+		{
+			if (f != factor)
+			{
+				removePair(old, testCase.atIndex(f));
+				addPair(component, testCase.atIndex(f));
+			}
+		}
+		testCase.setComponent(factor, component);
+	}
+
+	//returns a uniformly distributed number in [0, 1)
+	static double next01(RandomStream& rng)
+	{
+		return (rng.next() >> 11) * (1.0 / 9007199254740992.0);
+	}
+
+	//returns true if the row breaks no constraint with the cell given the component
+	bool allowsMove(int row, int factor, int component, const ConstraintSet& constraints)
+	{
+		if (constraints.empty())
+		{
+			return true;
+		}
+		TestCase& testCase = rows[row];
+		int old = testCase.atIndex(factor);
+		testCase.setComponent(factor, -1);
+		bool allowed = constraints.allows(component, testCase);
+		testCase.setComponent(factor, old);
+		return allowed;
+	}
+
+	/**
+	 *
+	 *	This function anneals the chain until every pair is
+	 *  covered again. Each move takes a random uncovered pair
+	 *  and a random row that may change, and gives the row one
+	 *  of the pair's two components, whichever leaves fewer
+	 *  pairs uncovered. A move that uncovers more than it
+	 *  covers is still taken with probability exp(-delta / T),
+	 *  and T cools after every movesPerCheck moves, starting
+	 *  over once it is cold. The chain gives up when the
+	 *  deadline passes or another chain has succeeded.
+	 *
+	 *	Returns true if the chain covers every pair.
+	 *
+	 */
+	bool anneal(const ConstraintSet& constraints, int fixedRows, steady_clock::time_point deadline, const atomic<int>& winner, RandomStream& rng)
+	{
+		double temperature = startTemperature;
+		for (long long moves = 1; !uncovered.empty(); moves++)
+		{
+			if (moves % movesPerCheck == 0)
+			{
+				temperature *= coolingRate;
+				if (temperature < finalTemperature)
+				{
+					temperature = startTemperature;
+				}
+				if (winner.load() >= 0 || steady_clock::now() >= deadline)
+				{
+					return false;
+				}
+			}
+
+			int pair = uncovered[rng.below(uncovered.size())];
+			int choices[2] = { pair / components, pair % components };
+			int row = fixedRows + rng.below(rows.size() - fixedRows);
+			int bestChoice = -1;
+			int bestDelta = 0;
+			for (int c = 0; c != 2; c++)
+			{
+				int factor = (*componentFactor)[choices[c]];
+				if (rows[row].atIndex(factor) == choices[c] || !allowsMove(row, factor, choices[c], constraints))
+				{
+					continue;
+				}
+				int delta = moveDelta(row, factor, choices[c]);
+				if (bestChoice < 0 || delta < bestDelta || (delta == bestDelta && rng.below(2) == 0))
+				{
+					bestChoice = c;
+					bestDelta = delta;
+				}
+			}
+			if (bestChoice < 0)
+			{
+				continue;
+			}
+			if (bestDelta <= 0 || (next01(rng) < exp(-bestDelta / temperature)))
+			{
+				applyMove(row, (*componentFactor)[choices[bestChoice]], choices[bestChoice]);
+			}
+		}
+		return true;
+	}
+};
+
+/**
+ *
+ *	This function tries to make a complete pairwise suite
+ *  smaller within a time budget. Each round removes a row
+ *  and anneals the cells of the rest (see ShrinkChain) until
+ *  every pair is covered again; one chain per thread pool
+ *  slot searches from its own random stream, and the first
+ *  chain to succeed gives the suite for the next round. The
+ *  rounds stop when the budget runs out, when a round fails,
+ *  or when the suite reaches the product of the two largest
+ *  level counts (without constraints no suite is smaller).
+ *
+ *  Pairs the suite does not cover to begin with, which the
+ *  constraints make impossible, are not asked for, and no
+ *  move breaks a constraint. The first fixedRows rows (seed
+ *  rows) are kept as they are. The pair counts take 8 bytes
+ *  per cross-factor pair per chain, so fewer chains run on
+ *  models with very many components, and none beyond 1 GiB.
+ *  Since the chains race against the clock, the result
+ *  depends on the machine as well as the seed.
+ *
+ *	Returns the number of rows removed.
+ *
+ */
+int shrinkSuite(TestSuite& suite, vector<int>& levels, ConstraintSet& constraints, ThreadPool& pool, uint64_t seed, double seconds, int fixedRows)
+{
+	steady_clock::time_point deadline = steady_clock::now() + duration_cast<steady_clock::duration>(duration<double>(seconds));
+	int factors = levels.size();
+	int startRows = suite.size();
+	if (factors < 2 || startRows - fixedRows < 2)
+	{
+		return 0;
+	}
+
+	//pairs are numbered by their smaller component, then by the larger one (same-factor pairs keep unused slots)
+	vector<int> factorBegin = factorStartingNums(levels);
+	int totalComponents = countComponents(levels);
+	vector<int> factorOf(totalComponents);
+	for (int f = 0; f != factors; f++)
+	{
+		fill(factorOf.begin() + factorBegin[f], factorOf.begin() + factorBegin[f] + levels[f], f);
+	}
+	vector<size_t> pairStart(totalComponents + 1, 0);
+	for (int c = 0; c != totalComponents; c++)
+	{
+		pairStart[c + 1] = pairStart[c] + (totalComponents - c - 1);
+	}
+
+	int chains = pool.slots();
+	size_t chainBytes = pairStart.back() * (sizeof(uint32_t) + sizeof(int));
+	while (chains > 1 && chainBytes * chains > maxCountBytes)
+	{
+		chains--;
+	}
+	if (chainBytes > maxCountBytes)
+	{
+		return 0;
+	}
+
+	//no suite without constraints is smaller than the two largest factors' combinations
+	vector<int> sortedLevels = levels;
+	sort(sortedLevels.rbegin(), sortedLevels.rend());
+	int lowerBound = constraints.empty() ? sortedLevels[0] * sortedLevels[1] : 0;
+
+	vector<TestCase> best(startRows);
+	for (int r = 0; r != startRows; r++)
+	{
+		best[r].reset(factors);
+		for (int f = 0; f != factors; f++)
+		{
+			best[r].setComponent(f, suite.at(r, f));
+		}
+	}
+
+	vector<ShrinkChain> chain(chains);
+	for (int round = 0; best.size() > lowerBound && best.size() - fixedRows >= 2 && steady_clock::now() < deadline; round++)
+	{
+		atomic<int> winner(-1);
+		pool.parallelFor(chains, [&](int c)
+		{
+			RandomStream rng(seed, shrinkStreams + (uint64_t)round * chains + c);
+			chain[c].load(best, pairStart, factorOf, fixedRows, rng);
+			if (chain[c].anneal(constraints, fixedRows, deadline, winner, rng))
+			{
+				int none = -1;
+				winner.compare_exchange_strong(none, c);
+			}
+		});
+		if (winner.load() < 0)
+		{
+			break;
+		}
+		best = chain[winner.load()].suiteRows();
+	}
+
+	suite.reset(factors, totalComponents);
+	for (int r = 0; r != best.size(); r++)
+	{
+		suite.appendRow(best[r]);
+	}
+	return startRows - best.size();
+}
\ No newline at end of file
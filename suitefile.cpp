@@ -0,0 +1,246 @@
+#include "suitefile.h"
+#include "aetgfunctions.h"
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <limits.h>
+#include <fstream>
+
+using namespace std;
+
+/**
+ *
+ *	This function stores a number in little-endian order
+ *  at the given position of a buffer.
+ *
+ *	Returns no value(s).
+ *
+ */
+static void putNumber(unsigned char* position, uint64_t value, int bytes)
+{
+	for (int b = 0; b != bytes; b++)
+	{
+		position[b] = (unsigned char)(value >> (8 * b));
+	}
+}
+
+/**
+ *
+ *	This function reads a little-endian number from the
+ *  given position of a buffer.
+ *
+ *	Returns the number.
+ *
+ */
+static uint64_t getNumber(const unsigned char* position, int bytes)
+{
+	uint64_t value = 0;
+	for (int b = 0; b != bytes; b++)
+	{
+		value |= (uint64_t)position[b] << (8 * b);
+	}
+	return value;
+}
+
+/**
+ *
+ *	This function works out where the rows of a binary
+ *  suite file start: after the header and the levels,
+ *  rounded up so that rows start 8-byte aligned.
+ *
+ *	Returns the offset of the first row in bytes.
+ *
+ */
+static size_t suiteDataOffset(int factors)
+{
+	return (suiteFileHeaderSize + 4 * (size_t)factors + 7) & ~(size_t)7;
+}
+
+/**
+ *
+ *	This function looks at the first bytes of a file to
+ *  tell a binary suite file from a text one.
+ *
+ *	Returns true if the file starts with the suite file magic.
+ *
+ */
+bool isSuiteFile(const string& fileName)
+{
+	ifstream inputFile(fileName.c_str(), ios::binary);
+	char magic[sizeof(suiteFileMagic)];
+	return inputFile.read(magic, sizeof(magic)) && memcmp(magic, suiteFileMagic, sizeof(magic)) == 0;
+}
+
+/**
+ *
+ *	This function writes a suite to a binary suite file
+ *  (see suitefile.h). Each component is stored as its level
+ *  index, in 1, 2 or 4 bytes depending on the largest
+ *  factor, and the rows are written in blocks rather than
+ *  one at a time.
+ *
+ *	Returns true if the whole file could be written.
+ *
+ */
+bool outputSuiteBinary(TestSuite& selectedSuite, vector<int>& levels, const string& fileName)
+{
+	ofstream outputFile(fileName.c_str(), ios::binary);
+	if (!outputFile)
+	{
+		return false;
+	}
+
+	int factors = levels.size();
+	int largestFactor = *max_element(levels.begin(), levels.end());
+	int width = largestFactor <= 0x100 ? 1 : (largestFactor <= 0x10000 ? 2 : 4);
+	vector<int> factorBegin = factorStartingNums(levels);
+
+	//header and levels, padded so the rows start aligned
+	vector<unsigned char> block(suiteDataOffset(factors), 0);
+	memcpy(block.data(), suiteFileMagic, sizeof(suiteFileMagic));
+	putNumber(&block[8], suiteFileVersion, 4);
+	putNumber(&block[12], factors, 4);
+	putNumber(&block[16], selectedSuite.size(), 8);
+	putNumber(&block[24], width, 4);
+	for (int f = 0; f != factors; f++)
+	{
+		putNumber(&block[suiteFileHeaderSize + 4 * f], levels[f], 4);
+	}
+	outputFile.write((const char*)block.data(), block.size());
+
+	//rows go out in blocks of about 64 KB
+	size_t rowBytes = (size_t)factors * width;
+	int rowsPerBlock = max(1, (int)((1 << 16) / rowBytes));
+	block.resize(rowsPerBlock * rowBytes);
+	for (int first = 0; first < selectedSuite.size(); first += rowsPerBlock)
+	{
+		int count = min(rowsPerBlock, selectedSuite.size() - first);
+		for (int r = 0; r != count; r++)
+		{
+			for (int f = 0; f != factors; f++)
+			{
+				putNumber(&block[r * rowBytes + f * width], selectedSuite.at(first + r, f) - factorBegin[f], width);
+			}
+		}
+		outputFile.write((const char*)block.data(), count * rowBytes);
+	}
+	outputFile.close();
+	return !outputFile.fail();
+}
+
+MappedSuite::MappedSuite()
+{
+	mapping = NULL;
+	mappingSize = 0;
+	cells = NULL;
+	rowCount = 0;
+	width = 1;
+}
+
+MappedSuite::~MappedSuite()
+{
+	close();
+}
+
+/**
+ *
+ *	This function maps a binary suite file read-only and
+ *  checks its header, levels and size. Nothing but the
+ *  header and the levels is read; rows are read from the
+ *  mapping only when asked for.
+ *
+ *	Returns true if the file is a valid suite file, otherwise
+ *  sets error and returns false.
+ *
+ */
+bool MappedSuite::open(const string& fileName, string& error)
+{
+	close();
+	int descriptor = ::open(fileName.c_str(), O_RDONLY);
+	if (descriptor < 0)
+	{
+		error = "Could not open suite file " + fileName + ".";
+		return false;
+	}
+	struct stat info;
+	if (fstat(descriptor, &info) != 0 || info.st_size < (off_t)suiteFileHeaderSize)
+	{
+		::close(descriptor);
+		error = fileName + " is too short to be a suite file.";
+		return false;
+	}
+	void* address = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, descriptor, 0);
+	::close(descriptor);
+	if (address == MAP_FAILED)
+	{
+		error = "Could not map suite file " + fileName + ".";
+		return false;
+	}
+	mapping = (const unsigned char*)address;
+	mappingSize = info.st_size;
+
+	//check the header before trusting any of the sizes in it
+	uint64_t factors = getNumber(mapping + 12, 4);
+	uint64_t rows = getNumber(mapping + 16, 8);
+	width = getNumber(mapping + 24, 4);
+	if (memcmp(mapping, suiteFileMagic, sizeof(suiteFileMagic)) != 0)
+	{
+		error = fileName + " is not a suite file.";
+	}
+	else if (getNumber(mapping + 8, 4) != suiteFileVersion)
+	{
+		error = fileName + " is suite file version " + to_string(getNumber(mapping + 8, 4)) + ", only version " + to_string(suiteFileVersion) + " can be read.";
+	}
+	else if (factors == 0 || (width != 1 && width != 2 && width != 4) || suiteDataOffset(factors) > mappingSize || rows > (mappingSize - suiteDataOffset(factors)) / (factors * width))
+	{
+		error = fileName + " has a damaged header or is cut short.";
+	}
+	else
+	{
+		//every level index must fit a cell, and every component number an int
+		uint64_t cellLimit = width == 4 ? INT_MAX : (uint64_t)1 << (8 * width);
+		uint64_t components = 0;
+		bool levelsValid = true;
+		factorLevels.resize(factors);
+		for (int f = 0; f != factors && levelsValid; f++)
+		{
+			uint64_t levels = getNumber(mapping + suiteFileHeaderSize + 4 * f, 4);
+			components += levels;
+			levelsValid = levels != 0 && levels <= cellLimit && components <= INT_MAX;
+			factorLevels[f] = (int)levels;
+		}
+		if (levelsValid)
+		{
+			factorBegin = factorStartingNums(factorLevels);
+			cells = mapping + suiteDataOffset(factors);
+			rowCount = rows;
+			return true;
+		}
+		error = fileName + " has a damaged header or is cut short.";
+	}
+	close();
+	return false;
+}
+
+/**
+ *
+ *	This function unmaps the file, if one is mapped.
+ *
+ *	Returns no value(s).
+ *
+ */
+void MappedSuite::close()
+{
+	if (mapping != NULL)
+	{
+		munmap((void*)mapping, mappingSize);
+	}
+	mapping = NULL;
+	mappingSize = 0;
+	cells = NULL;
+	factorLevels.clear();
+	factorBegin.clear();
+	rowCount = 0;
+}
@@ -0,0 +1,124 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ *
+ *  Binary suite files (version 1) hold a suite as level
+ *  indices instead of text. All numbers are little-endian.
+ *
+ *    offset  size  field
+ *    0       8     magic "AETGSUIT"
+ *    8       4     format version
+ *    12      4     number of factors
+ *    16      8     number of rows
+ *    24      4     cell width in bytes (1, 2 or 4)
+ *    28      4     reserved, 0
+ *    32      4*n   levels of each factor
+ *    ...           zero padding to a multiple of 8 bytes
+ *    ...           rows, row-major, one cell per factor
+ *
+ *  A cell holds the level index within its factor, in the
+ *  narrowest width that fits the largest factor. Adding
+ *  factorStartingNums() of the levels gives back the
+ *  component numbers of testsuite.txt.
+ *
+ */
+static const char suiteFileMagic[8] = { 'A', 'E', 'T', 'G', 'S', 'U', 'I', 'T' };
+static const uint32_t suiteFileVersion = 1;
+static const size_t suiteFileHeaderSize = 32;
+
+/**
+ *
+ *  This class maps a binary suite file into memory and
+ *  reads rows straight out of the mapping, so a reader
+ *  that only needs a slice of the rows (one shard of a
+ *  distributed run) touches only the pages of that slice
+ *  and never parses the rest of the file.
+ *
+ */
+class MappedSuite
+{
+private:
+	const unsigned char* mapping;
+	size_t mappingSize;
+	const unsigned char* cells;
+	std::vector<int> factorLevels;
+	std::vector<int> factorBegin;
+	long long rowCount;
+	int width;
+
+	MappedSuite(const MappedSuite&);
+	MappedSuite& operator=(const MappedSuite&);
+public:
+	MappedSuite();
+	~MappedSuite();
+
+	//maps a suite file, returns false and sets error if it cannot be read or is not a valid suite file
+	bool open(const std::string& fileName, std::string& error);
+
+	//unmaps the file, rows can no longer be read
+	void close();
+
+	//returns the number of rows (test cases) in the suite
+	long long size() const
+	{
+		return rowCount;
+	}
+
+	//returns the number of factors in every row
+	int factors() const
+	{
+		return factorLevels.size();
+	}
+
+	//returns the number of levels of every factor
+	const std::vector<int>& levels() const
+	{
+		return factorLevels;
+	}
+
+	//returns how many bytes each cell uses
+	int cellWidth() const
+	{
+		return width;
+	}
+
+	//returns the raw cells of a row, factors() cells of cellWidth() bytes each
+	const unsigned char* rowData(long long row) const
+	{
+		return cells + (size_t)row * factorLevels.size() * width;
+	}
+
+	//returns the level index selected for a factor in a row
+	int level(long long row, int factor) const
+	{
+		const unsigned char* cell = rowData(row) + (size_t)factor * width;
+		switch (width)
+		{
+		case 1:
+			return cell[0];
+		case 2:
+			return cell[0] | cell[1] << 8;
+		default:
+			return cell[0] | cell[1] << 8 | cell[2] << 16 | (uint32_t)cell[3] << 24;
+		}
+	}
+
+	//returns the component number selected for a factor in a row, as in testsuite.txt
+	int at(long long row, int factor) const
+	{
+		return factorBegin[factor] + level(row, factor);
+	}
+
+	//copies the component numbers of a row into a caller's array of factors() ints
+	void readRow(long long row, int* components) const
+	{
+		for (int f = 0; f != factorLevels.size(); f++)
+		{
+			components[f] = at(row, f);
+		}
+	}
+};
@@ -1,10 +1,23 @@
 #include "aetgfunctions.h"
 #include <algorithm>
 #include <numeric>
-#include <random>
 #include <fstream>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include "threadpool.h"
 
 using namespace std;
+using namespace std::chrono;
+
+//candidates are only scored in parallel once factors x components reaches this size
+static const int parallelCandidateWork = 4096;
+
+//how many times a test case is built around a pair before the pair is given up as impossible
+static const int pairRetries = 20;
+
+//walking one listed partner is taken to cost this many grid words, for deciding when the end game starts
+static const int endGameCost = 4;
 
 /**
  *
@@ -13,19 +26,22 @@ using namespace std;
  *  factor. Since all pairs are uncovered before the first
  *  test case, randomization of all components is possible.
  *
- *	Returns a test case with selected components for each factor.
+ *	Returns no value(s), the test case is filled in place.
  *
  */
-TestCase firstTestGenerator(int factors, vector<int>& levels, vector<vector<int>>& grid)
+template <typename Index, int RowWords>
+void firstTestGenerator(BasicTestCase<Index>& firstCase, int factors, vector<int>& levels, CoverageGrid& grid, RandomStream& rng, CandidateScratch& scratch)
 {
-	//creates an empty test case and vector for random factor ordering
-	TestCase firstCase(factors);
-	vector<int> factorOrder(factors);
+	//clear the test case and the vector for random factor ordering
+	AETG_PHASE(phaseFirstCase);
+	vector<int>& factorOrder = scratch.factorOrder;
 	int currentComponent = -1;
 	int factorStart = 0;
+	firstCase.reset(factors);
+	factorOrder.resize(factors);
 
 	//randomize order for factor selection
-	factorShuffle(factorOrder);
+	factorShuffle(factorOrder, rng);
 
 	//select each factor from the randomized list
 	for (int i = 0; i != factorOrder.size(); i++)
@@ -39,130 +55,248 @@ TestCase firstTestGenerator(int factors, vector<int>& levels, vector<vector<int>
 		}
 		
 		//select a random component from the current factor and store it in the test case
-		currentComponent = factorStart + (rand() % levels[factorOrder[i]]);
+		currentComponent = factorStart + rng.below(levels[factorOrder[i]]);
 		firstCase.setComponent(factorOrder[i], currentComponent);
 
 	}
 	//count new pairs created with the first test case (this case will have maximum new pairs)
-	countNewPairs(firstCase, grid);
-	
-	return firstCase;
+	countNewPairs<Index, RowWords>(firstCase, grid);
 }
 
 /**
  *
  *	This function creates test cases by randomizing the
- *  factor order. The generator first chooses a random
- *  component for the first factor in the shuffled factor
- *  list. Each subsequent factor is chosen based on how many
- *  new pairs each of its components can make with previously
- *  selected components in the test case. The components
- *  which make the most new pairs are pooled and a random
- *  component from the pool is selected for the corresponding
- *  factor.
+ *  factor order. The generator first chooses one of the
+ *  components with the most uncovered pairs across the
+ *  whole model (the classic AETG rule) and places it in the
+ *  test case, then completeTestCase() fills in the rest of
+ *  the factors.
  *
- *	Returns a test case with selected components for each factor.
+ *	Returns no value(s), the test case is filled in place.
  *
  */
-TestCase testGenerator(int factors, vector<int>& levels, vector<int>& pairsRemaining, vector<int>& factorBegin, int totalComponents, vector<vector<int>>& grid)
+template <typename Index, int RowWords>
+void testGenerator(BasicTestCase<Index>& testCase, int factors, vector<int>& levels, UncoveredCounts& pairsRemaining, vector<int>& factorBegin, CoverageGrid& grid, PairWorklist& worklist, ConstraintSet& constraints, RandomStream& rng, CandidateScratch& scratch)
 {
-	//creates an empty test case, a vector for random factor ordering, and a vector to pool the best component choices
-	TestCase testCase(factors);
-	vector<int> factorOrder(factors);
-	vector<int> maxPairs;
-	int maxPairsLeft = 0;
-	int currentFactor = -1;
+	testCase.reset(factors);
+
+	//the bucket queue holds every component tied for the most remaining pairs, pick one at random
+	int selectedComponent = pairsRemaining.best(rng.below(pairsRemaining.bestCount()));
+	testCase.setComponent(grid.factorOf(selectedComponent), selectedComponent);
+
+	//choose the rest of the components by the new pairs they make
+	completeTestCase<Index, RowWords>(testCase, levels, factorBegin, grid, worklist, constraints, rng, scratch);
+}
+
+/**
+ *
+ *	This function fills in every factor of a test case that
+ *  does not have a component yet, in a random factor order.
+ *  Each factor is chosen based on how many new pairs each
+ *  of its components can make with previously selected
+ *  components in the test case. The components which make
+ *  the most new pairs are pooled and a random component
+ *  from the pool is selected for the corresponding factor.
+ *  In the end game of a suite the new pairs of a component
+ *  are counted from the worklist of uncovered pairs instead
+ *  of the grid, which gives the same counts.
+ *
+ *  Components that would break a constraint are left out
+ *  of the pool. Only the component drawn from the pool is
+ *  checked: its forbidden row is ANDed with the selected
+ *  components and the forbidden combinations it belongs to
+ *  are looked at. If it breaks a constraint it is ruled
+ *  out and the pool is formed again. If every
+ *  component of a factor is ruled out the test case is a
+ *  dead end and is marked with -1 new pairs.
+ *
+ *  When the grid's row width is known at compile time
+ *  (RowWords is not 0) the mask of selected components is
+ *  kept on the stack and the grid rows are found without
+ *  reading the width.
+ *
+ *	Returns true if every factor could be filled in.
+ *
+ */
+template <typename Index, int RowWords>
+bool completeTestCase(BasicTestCase<Index>& testCase, vector<int>& levels, vector<int>& factorBegin, CoverageGrid& grid, PairWorklist& worklist, ConstraintSet& constraints, RandomStream& rng, CandidateScratch& scratch)
+{
+	//clear the vector for random factor ordering and the vector to pool the best component choices
+	vector<int>& factorOrder = scratch.factorOrder;
+	vector<int>& maxPairs = scratch.maxPairs;
+	int factors = testCase.testSize();
 	int selectedComponent = -1;
-	int numFactorsSelected = 0;
 	int totalNewPairs = 0;
+	factorOrder.resize(factors);
 
-	//randomize order for factor selection
-	factorShuffle(factorOrder);
+	//bitmask of the components selected so far, ANDed with grid rows to score each factor's levels
+	int rowWords = RowWords != 0 ? RowWords : grid.wordsPerRow();
+	uint64_t narrowMask[RowWords != 0 ? RowWords : 1];
+	uint64_t* selectedMask = narrowMask;
+	if (RowWords != 0)
+	{
+		fill(narrowMask, narrowMask + rowWords, (uint64_t)0);
+	}
+	else
+	{
+		scratch.selectedMask.assign(rowWords, 0);
+		selectedMask = scratch.selectedMask.data();
+	}
+	vector<int>& levelScores = scratch.levelScores;
+	vector<int>& levelConflicts = scratch.levelConflicts;
+	levelScores.resize(*max_element(levels.begin(), levels.end()));
+	levelConflicts.resize(levelScores.size());
 
-	//start with the first factor in the randomly ordered list
-	currentFactor = factorOrder[0];
-	
-	//find the max number of remaining pairs from the currently selected factor's components
-	maxPairsLeft = *max_element(pairsRemaining.begin() + factorBegin[currentFactor], pairsRemaining.begin() + factorBegin[currentFactor] + levels[currentFactor]);
+	//the pool is filled through a count, so forming it never has to grow the vector
+	maxPairs.resize(levelScores.size());
+	int pooled = 0;
 
-	//pool all components in the current factor that have the max number of remaining pairs
-	for (int i = factorBegin[currentFactor]; i != factorBegin[currentFactor] + levels[currentFactor]; i++)
+	//components already in the test case count the new pairs they make with each other
+	for (int f = 0; f != factors; f++)
 	{
-		if (pairsRemaining[i] == maxPairsLeft)
+		if (testCase.atIndex(f) >= 0)
 		{
-			maxPairs.push_back(i);
+			int newPairs = 0;
+			scoreLevels(grid.row<RowWords>(testCase.atIndex(f)), 1, rowWords, selectedMask, &newPairs);
+			totalNewPairs += newPairs;
+			selectedMask[testCase.atIndex(f) >> 6] |= (uint64_t)1 << (testCase.atIndex(f) & 63);
 		}
 	}
-	//use rand() % maxPairs.size() to select a component for the current factor
-	selectedComponent = rand() % maxPairs.size();
 
-	//add selected component to the test case in the correct factor position
-	testCase.setComponent(currentFactor, maxPairs[selectedComponent]);
-	
-	//keep track of how many factors have been selected so far
-	numFactorsSelected++;
-		
+	//randomize order for factor selection
+	factorShuffle(factorOrder, rng);
+
 	//for the remaining factors, components are chosen by potential new pairs formed
-	for (int i = 1; i != factorOrder.size(); i++)
+	for (int i = 0; i != factorOrder.size(); i++)
 	{
-		int possiblePairs = 0;
-		int currentMaxPairs = 0;
+		int currentFactor = factorOrder[i];
+		int currentMaxPairs = -1;
+		if (testCase.atIndex(currentFactor) >= 0)
+		{
+			continue;
+		}
 
-		//select the next factor in the randomly ordered list
-		currentFactor = factorOrder[i];
-		
-		//reset pool of best-fit components for the current factor
-		maxPairs.clear();
-		
-		//count the number of new pairs that the current component makes with previously selected components
-		for (int i = factorBegin[currentFactor]; i != factorBegin[currentFactor] + levels[currentFactor]; i++)
+		//count the number of new pairs that every component of the factor makes with previously selected components,
+		//in the end game by walking each component's few listed partners instead of its whole grid row
+		if (worklist.isActive())
 		{
-			possiblePairs = 0;
-			
-			//check the grid to see if the current component can pair with the previously selected components
-			for (int j = 0; j != numFactorsSelected; j++)
+			for (int l = 0; l != levels[currentFactor]; l++)
 			{
-				if (grid[i][testCase.atIndex(factorOrder[j])] == 0)
+				int component = factorBegin[currentFactor] + l;
+				int possiblePairs = 0;
+				for (const int* partner = worklist.partnersBegin(component); partner != worklist.partnersEnd(component); partner++)
 				{
-					possiblePairs++;
+					possiblePairs += testCase.atIndex(grid.factorOf(*partner)) == *partner;
 				}
+				levelScores[l] = possiblePairs;
+				AETG_COUNT(counterPartnerProbes, worklist.partnersEnd(component) - worklist.partnersBegin(component));
 			}
-			//check to see if the current component makes the most new pairs
-			if (possiblePairs > currentMaxPairs)
+		}
+		else
+		{
+			scoreLevels(grid.row<RowWords>(factorBegin[currentFactor]), levels[currentFactor], rowWords, selectedMask, levelScores.data());
+			AETG_COUNT(counterGridProbes, levels[currentFactor]);
+		}
+
+		//components ruled out by the constraints for this factor
+		fill(levelConflicts.begin(), levelConflicts.begin() + levels[currentFactor], 0);
+
+		//the pooled component is only checked against the constraints once it is drawn, and if it breaks
+		//one it is ruled out and the pool is formed again, so most components are never checked
+		selectedComponent = -1;
+		while (selectedComponent < 0)
+		{
+			currentMaxPairs = -1;
+			pooled = 0;
+			for (int l = 0; l != levels[currentFactor]; l++)
 			{
-				currentMaxPairs = possiblePairs;
-				//reset vector with just this component in it
-				maxPairs.clear();
-				maxPairs.push_back(i);
+				int possiblePairs = levelScores[l];
+
+				//skip components that cannot beat the pool or would break a constraint
+				if (possiblePairs < currentMaxPairs || levelConflicts[l] != 0)
+				{
+					continue;
+				}
+
+				//check to see if the current component makes the most new pairs
+				if (possiblePairs > currentMaxPairs)
+				{
+					currentMaxPairs = possiblePairs;
+					//reset the pool with just this component in it
+					pooled = 0;
+				}
+				//add to pool of best components
+				maxPairs[pooled++] = factorBegin[currentFactor] + l;
 			}
-			else if (possiblePairs == currentMaxPairs)
+
+			//every component of the factor breaks a constraint, so this test case cannot be finished
+			if (pooled == 0)
 			{
-				//add to pool of best components
-				maxPairs.push_back(i);
+				testCase.setNewPairs(-1);
+				return false;
 			}
-			else
+
+			//select a random component from the pool of components that make the most new pairs
+			AETG_COUNT(counterLevelTies, pooled - 1);
+			selectedComponent = maxPairs[rng.below(pooled)];
+			if (constraints.forbidsAny(selectedComponent, selectedMask) || (constraints.hasTuples() && constraints.completesTuple(selectedComponent, selectedMask)))
 			{
-				//component is not a best fit
-				continue;
+				AETG_COUNT(counterConstraintRejects, 1);
+				levelConflicts[selectedComponent - factorBegin[currentFactor]] = 1;
+				selectedComponent = -1;
 			}
 		}
-		//select a random component from the pool of components that make the most new pairs
-		selectedComponent = rand() % maxPairs.size();
 
 		//store the selected component in the test case at the correct factor position
-		testCase.setComponent(currentFactor, maxPairs[selectedComponent]);
-		
-		//keep track of how many factors have been selected so far
-		numFactorsSelected++;
+		testCase.setComponent(currentFactor, selectedComponent);
+		selectedMask[selectedComponent >> 6] |= (uint64_t)1 << (selectedComponent & 63);
 
 		//keep track of how many new pairs this test case has created so far
 		totalNewPairs += currentMaxPairs;
-
 	}
 	//update the test case to contain the total number of new pairs created
 	testCase.setNewPairs(totalNewPairs);
+	return true;
+}
+
+/**
+ *
+ *	This function is used when none of the candidates
+ *  covers a new pair, which can only happen when
+ *  constraints rule out the components the generator
+ *  wanted. It takes one of the components with the most
+ *  uncovered pairs and one of its uncovered partners and
+ *  tries to build a valid test case around the pair. If
+ *  that keeps failing, the pair is taken to be impossible
+ *  under the constraints: it is marked as covered so the
+ *  loop in selectSuite() can finish, and it is counted.
+ *
+ *	Returns true if the test case holds a valid row that covers the pair.
+ *
+ */
+template <typename Index, int RowWords>
+bool buildAroundPair(BasicTestCase<Index>& testCase, vector<int>& levels, UncoveredCounts& pairsRemaining, vector<int>& factorBegin, CoverageGrid& grid, PairWorklist& worklist, ConstraintSet& constraints, RandomStream& rng, CandidateScratch& scratch, int& uncoverablePairs)
+{
+	AETG_PHASE(phaseBuildAround);
+	int first = pairsRemaining.best(rng.below(pairsRemaining.bestCount()));
+	int second = grid.firstUncovered(first);
+
+	for (int attempt = 0; attempt != pairRetries; attempt++)
+	{
+		testCase.reset(levels.size());
+		testCase.setComponent(grid.factorOf(first), first);
+		testCase.setComponent(grid.factorOf(second), second);
+		if (completeTestCase<Index, RowWords>(testCase, levels, factorBegin, grid, worklist, constraints, rng, scratch))
+		{
+			return true;
+		}
+	}
 
-	return testCase;
+	//no test case can hold the pair, stop looking for it
+	grid.cover<RowWords>(first, second);
+	pairsRemaining.coverPair(first, second);
+	uncoverablePairs++;
+	return false;
 }
 
 /**
@@ -174,7 +308,7 @@ TestCase testGenerator(int factors, vector<int>& levels, vector<int>& pairsRemai
  *	Returns no value(s).
  *
  */
-void factorShuffle(vector<int>& factorOrder)
+void factorShuffle(vector<int>& factorOrder, RandomStream& rng)
 {
 	//initialize the vector so that each index has the corresponding factor number as a value
 	for (int i = 0; i != factorOrder.size(); i++)
@@ -182,10 +316,11 @@ void factorShuffle(vector<int>& factorOrder)
 		factorOrder[i] = i;
 	}
 
-	//seeds a random number generator to shuffle the factor ordering
-	random_device device;
-	auto randomNums = default_random_engine{ device() };
-	shuffle(factorOrder.begin(), factorOrder.end(), randomNums);
+	//Fisher-Yates shuffle of the factor ordering with the caller's random number stream
+	for (int i = factorOrder.size() - 1; i > 0; i--)
+	{
+		swap(factorOrder[i], factorOrder[rng.below(i + 1)]);
+	}
 }
 
 /**
@@ -198,17 +333,22 @@ void factorShuffle(vector<int>& factorOrder)
  *	Returns no value(s).
  *
  */
-void countNewPairs(TestCase& currentTestCase, vector<vector<int>>& grid)
+template <typename Index, int RowWords>
+void countNewPairs(BasicTestCase<Index>& currentTestCase, CoverageGrid& grid)
 {
 	int newPairCounter = 0;
+	int factors = currentTestCase.testSize();
+	const Index* cells = currentTestCase.getTest().data();
+	const int bias = BasicTestCase<Index>::bias;
+	AETG_COUNT(counterGridProbes, factors * (factors - 1) / 2);
 	
 	//count the number of new pairs that the current component makes with previously selected components
-	for (int i = 0; i != currentTestCase.testSize(); i++)
+	for (int i = 0; i != factors; i++)
 	{
-		for (int j = i+1; j != currentTestCase.testSize(); j++)
+		for (int j = i+1; j != factors; j++)
 		{
 			//check the grid at the two components intersection to see if the pair is currently not covered
-			if (grid[currentTestCase.atIndex(i)][currentTestCase.atIndex(j)] == 0)
+			if (grid.isUncovered<RowWords>(cells[i] - bias, cells[j] - bias))
 			{
 				newPairCounter++;
 			}
@@ -220,87 +360,145 @@ void countNewPairs(TestCase& currentTestCase, vector<vector<int>>& grid)
 
 /**
  *
- *	This function creates 50 test case candidates, adds
+ *	This function creates the given number of test case
+ *  candidates (50, or fewer or more in adaptive runs), adds
  *  the candidates which form the most new pairs to a pool,
  *  and randomly selects a test case from the pool to be
- *  added to the test suite.  
+ *  added to the test suite. For larger models the
+ *  candidates are scored in parallel on the thread pool.
+ *  Each candidate draws from its own random stream and the
+ *  pool of ties is formed in candidate order afterwards, so
+ *  the selection does not depend on which thread built
+ *  which candidate. The candidates are built into reusable
+ *  slots, one test case and scratch buffer per candidate.
+ *  Candidates that ran into a constraint dead end have -1
+ *  new pairs and are never selected over a valid one.
  *
- *	Returns a test case that creates the most new pairs.
+ *	Returns the candidate slot holding a test case that creates the most new pairs.
  *
  */
-TestCase selectCandidate(int factors, vector<int>& levels, vector<int>& pairsRemaining, vector<int>& factorBegin, int totalComponents, vector<vector<int>>& grid)
+template <typename Index, int RowWords>
+BasicTestCase<Index>& selectCandidate(vector<BasicTestCase<Index>>& generated, vector<CandidateScratch>& scratch, int candidates, int factors, vector<int>& levels, UncoveredCounts& pairsRemaining, vector<int>& factorBegin, int totalComponents, CoverageGrid& grid, PairWorklist& worklist, ConstraintSet& constraints, RandomStream& rng, ThreadPool& pool)
 {
-	//creates a vector to hold the best candidate test cases
-	vector<TestCase> candidates;
-	int currentMaxPairs = 0;
-	int selectedTest = -1;
+	AETG_PHASE(phaseCandidates);
+	AETG_COUNT(counterCandidates, candidates);
 
-	//create 50 candidate test cases
-	for (int i = 0; i != 50; i++)
+	//the buffers only grow, so a smaller count later does not give memory back
+	if (generated.size() < candidates)
 	{
-		TestCase newTest = testGenerator(factors, levels, pairsRemaining, factorBegin, totalComponents, grid);
+		generated.resize(candidates);
+		scratch.resize(candidates);
+	}
 
-		//check to see if the new test case makes the most new pairs
-		if (newTest.newPairsCount() > currentMaxPairs)
+	//every candidate gets its own stream derived from the suite's stream
+	uint64_t candidateSeed = rng.next();
+	auto buildCandidate = [&](int i)
+	{
+		RandomStream candidateRng(candidateSeed, i);
+		testGenerator<Index, RowWords>(generated[i], factors, levels, pairsRemaining, factorBegin, grid, worklist, constraints, candidateRng, scratch[i]);
+	};
+
+	//create the candidate test cases (50 unless adaptive), only sharing them out when each one is worth a task
+	if (factors * totalComponents >= parallelCandidateWork)
+	{
+		pool.parallelFor(candidates, buildCandidate);
+	}
+	else
+	{
+		for (int i = 0; i != candidates; i++)
 		{
-			currentMaxPairs = newTest.newPairsCount();
-			//reset vector with just this test case in it
-			candidates.clear();
-			candidates.push_back(newTest);
+			buildCandidate(i);
 		}
-		else if (newTest.newPairsCount() == currentMaxPairs)
+	}
+
+	//select a random test case from the pool of candidates that makes the most new pairs
+	return pickCandidate(generated, candidates, rng);
+}
+
+/**
+ *
+ *	This function pools the candidates that make the most
+ *  new pairs (or tuples) and randomly selects one of them.
+ *  The pool is formed in candidate order, so the selection
+ *  only depends on the random stream.
+ *
+ *	Returns the selected candidate.
+ *
+ */
+template <typename Index>
+BasicTestCase<Index>& pickCandidate(vector<BasicTestCase<Index>>& generated, int count, RandomStream& rng)
+{
+	int currentMaxPairs = 0;
+	int tiedCandidates = 0;
+	int selectedTest = -1;
+
+	//count the candidates that make the most new pairs
+	for (int i = 0; i != count; i++)
+	{
+		if (generated[i].newPairsCount() > currentMaxPairs)
 		{
-			//add to pool of best test cases
-			candidates.push_back(newTest);
+			currentMaxPairs = generated[i].newPairsCount();
+			tiedCandidates = 1;
 		}
-		else
+		else if (generated[i].newPairsCount() == currentMaxPairs)
 		{
-			//test case is not a good candidate
-			continue;
+			tiedCandidates++;
 		}
 	}
-	//select a random test case from the pool of candidates that makes the most new pairs
-	selectedTest = rand() % candidates.size();
 
-	return candidates[selectedTest];
+	//walk the candidates again to find the selected member of the pool
+	AETG_COUNT(counterCandidateTies, max(tiedCandidates - 1, 0));
+	selectedTest = rng.below(tiedCandidates);
+	for (int i = 0; i != count; i++)
+	{
+		if (generated[i].newPairsCount() == currentMaxPairs && selectedTest-- == 0)
+		{
+			return generated[i];
+		}
+	}
+	return generated[0];
 }
 
+//tway.cpp picks from int test cases
+template TestCase& pickCandidate<int>(vector<TestCase>& generated, int count, RandomStream& rng);
+
 /**
  *
  *	This function marks the grid with all new pairs found
  *  in a given test case. When a new pair is found, the
- *  vector which tracks how many pairs remain for a given
- *  component is updated. This is done by decrementing the
- *  index corresponding to each component in a new pair by 1.
+ *  counts which track how many pairs remain for a given
+ *  component are updated. This is done by decrementing the
+ *  count of each component in a new pair by 1, which also
+ *  lowers the total number of uncovered pairs.
  *
  *	Returns no value(s).
  *
  */
-void addToSuite(TestCase currentTestCase, vector<vector<int>>& grid, vector<int>& pairsRemaining)
+template <typename Index, int RowWords>
+void addToSuite(const BasicTestCase<Index>& currentTestCase, CoverageGrid& grid, UncoveredCounts& pairsRemaining)
 {
+	AETG_PHASE(phaseAddToSuite);
+	int factors = currentTestCase.testSize();
+	const Index* cells = currentTestCase.getTest().data();
+	const int bias = BasicTestCase<Index>::bias;
+	AETG_COUNT(counterGridProbes, factors * (factors - 1) / 2);
+
 	//check each factor's selected component one by one
-	for (int i = 0; i != currentTestCase.testSize(); i++)
+	for (int i = 0; i != factors; i++)
 	{
+		int first = cells[i] - bias;
+
 		//for each component, check each of the other selected components to determine new pairs
-		for (int j = i + 1; j != currentTestCase.testSize(); j++)
+		for (int j = i + 1; j != factors; j++)
 		{
 			//when the grid shows two components are not yet paired, mark that pair as covered
-			if (grid[currentTestCase.atIndex(i)][currentTestCase.atIndex(j)] == 0)
+			int second = cells[j] - bias;
+			if (grid.isUncovered<RowWords>(first, second))
 			{
-				grid[currentTestCase.atIndex(i)][currentTestCase.atIndex(j)] = 1;
-				grid[currentTestCase.atIndex(j)][currentTestCase.atIndex(i)] = 1;
-
-				//some components will be selected even after all pairs are covered
-				//do no decrement the pair counter any further after this occurs
-				if (pairsRemaining[currentTestCase.atIndex(i)] > 0)
-				{
-					pairsRemaining[currentTestCase.atIndex(i)]--;
-				}
+				grid.cover<RowWords>(first, second);
 
-				if (pairsRemaining[currentTestCase.atIndex(j)] > 0)
-				{
-					pairsRemaining[currentTestCase.atIndex(j)]--;
-				}
+				//only newly covered pairs are counted, so the counts never drop below zero
+				pairsRemaining.coverPair(first, second);
 			}
 		}
 	}
@@ -308,92 +506,435 @@ void addToSuite(TestCase currentTestCase, vector<vector<int>>& grid, vector<int>
 
 /**
  *
- *	This function creates 100 test suite candidates, adds
- *  the candidates which have the fewest test cases to a
- *  pool, and randomly selects a test suite from the pool.
- *  This suite is representative of the best possible outcome
- *  for this iteration of the program running.
+ *	This function builds the rows of one suite for
+ *  selectSuite(): the seed rows, the random first test case
+ *  when there are neither seed rows nor constraints, and
+ *  then the best of the candidates until every pair is
+ *  covered or the suite can no longer beat the smallest
+ *  one finished (pruned is set).
+ *
+ *  Index is the cell type of the candidates and RowWords
+ *  the grid's row width, or 0 if it is only known at run
+ *  time. pairRowBuilder() picks the instantiation for a
+ *  model, and every instantiation makes the same choices
+ *  and draws the same random numbers, so the suite does not
+ *  depend on which one builds it.
+ *
+ *	Returns false if the suite was given up at the deadline.
+ *
+ */
+template <typename Index, int RowWords>
+static bool buildSuiteRows(SuiteWorkspace& workspace, vector<int>& factorLevels, vector<int>& factorBegin, int totalComponents, ConstraintSet& constraints, GenerationOptions& options, bool streamRows, AttemptBudget& budget, SuiteBound& bound, atomic<int>& suitesDone, long long startingPairs, ThreadPool& pool, RandomStream& rng, int& uncoverablePairs, int& keptRows, bool& pruned)
+{
+	CoverageGrid& grid = workspace.grid;
+	UncoveredCounts& pairsRemaining = workspace.pairsRemaining;
+	TestSuite& testSuite = workspace.testSuite;
+	CandidateSlots<Index>& slots = workspace.slots(Index());
+	int seedRows = options.seedRows == NULL ? 0 : options.seedRows->size();
+
+	//the rows of an existing suite come first, their missing factors chosen by the new pairs they make
+	for (int r = 0; r != seedRows; r++)
+	{
+		AETG_PHASE(phaseSeedRows);
+		BasicTestCase<Index>& seedCase = slots.firstSelection;
+		bool filled = false;
+		for (int retry = 0; retry != pairRetries && !filled; retry++)
+		{
+			seedCase.assign((*options.seedRows)[r]);
+			filled = completeTestCase<Index, RowWords>(seedCase, factorLevels, factorBegin, grid, workspace.worklist, constraints, rng, workspace.scratch[0]);
+		}
+		if (!filled)
+		{
+			continue;
+		}
+		addToSuite<Index, RowWords>(seedCase, grid, pairsRemaining);
+		AETG_ROW(seedCase.newPairsCount());
+		testSuite.appendRow(seedCase);
+		keptRows++;
+		if (streamRows)
+		{
+			options.sink->writeRow(seedCase);
+		}
+	}
+
+	//generate our first test case randomly and add it to the suite
+	if (constraints.empty() && seedRows == 0)
+	{
+		firstTestGenerator<Index, RowWords>(slots.firstSelection, factorLevels.size(), factorLevels, grid, rng, workspace.scratch[0]);
+		addToSuite<Index, RowWords>(slots.firstSelection, grid, pairsRemaining);
+		AETG_ROW(slots.firstSelection.newPairsCount());
+		testSuite.appendRow(slots.firstSelection);
+		if (streamRows)
+		{
+			options.sink->writeRow(slots.firstSelection);
+		}
+	}
+
+	//continue generating all other test cases for the suite until no new pairs remain
+	while (pairsRemaining.uncoveredPairs() != 0)
+	{
+		if (budget.expired() && suitesDone != 0)
+		{
+			return false;
+		}
+
+		//give up on a suite that can no longer beat the smallest finished one
+		if (bound.cannotBeat(testSuite.size(), pairsRemaining))
+		{
+			pruned = true;
+			break;
+		}
+
+		//once scoring from a list of the uncovered pairs is cheaper than scoring from the grid, switch to the list
+		if (workspace.worklist.isActive() || pairsRemaining.uncoveredPairs() * 2 * endGameCost <= (long long)totalComponents * grid.wordsPerRow())
+		{
+			AETG_PHASE(phaseWorklist);
+			workspace.worklist.update(grid);
+		}
+
+		//generate a new test case randomly and add it to the suite
+		int candidates = budget.candidates(50, pairsRemaining.uncoveredPairs(), startingPairs);
+		BasicTestCase<Index>& nextSelection = selectCandidate<Index, RowWords>(slots.candidates, workspace.scratch, candidates, factorLevels.size(), factorLevels, pairsRemaining, factorBegin, totalComponents, grid, workspace.worklist, constraints, rng, pool);
+
+		//when no candidate makes progress, build a test case around one uncovered pair instead
+		if (nextSelection.newPairsCount() <= 0 && !buildAroundPair<Index, RowWords>(nextSelection, factorLevels, pairsRemaining, factorBegin, grid, workspace.worklist, constraints, rng, workspace.scratch[0], uncoverablePairs))
+		{
+			continue;
+		}
+		addToSuite<Index, RowWords>(nextSelection, grid, pairsRemaining);
+		AETG_ROW(nextSelection.newPairsCount());
+		testSuite.appendRow(nextSelection);
+		if (streamRows)
+		{
+			options.sink->writeRow(nextSelection);
+		}
+	}
+	return true;
+}
+
+//signature shared by every instantiation of buildSuiteRows()
+typedef bool (*SuiteRowBuilder)(SuiteWorkspace& workspace, vector<int>& factorLevels, vector<int>& factorBegin, int totalComponents, ConstraintSet& constraints, GenerationOptions& options, bool streamRows, AttemptBudget& budget, SuiteBound& bound, atomic<int>& suitesDone, long long startingPairs, ThreadPool& pool, RandomStream& rng, int& uncoverablePairs, int& keptRows, bool& pruned);
+
+/**
+ *
+ *	This function picks the narrowest instantiation of
+ *  buildSuiteRows() that a model fits. An unsigned cell
+ *  holds its component number plus one, so models of up to
+ *  255 components use byte cells, and for them the
+ *  grid's row width (one to four words) is also fixed at
+ *  compile time. Models of up to 65535 components use
+ *  16-bit cells and larger ones int cells, both with the
+ *  row width read at run time.
+ *
+ *	Returns the instantiation to build the model's suites with.
+ *
+ */
+static SuiteRowBuilder pairRowBuilder(int totalComponents)
+{
+	static const SuiteRowBuilder narrowBuilders[] = { buildSuiteRows<uint8_t, 1>, buildSuiteRows<uint8_t, 2>, buildSuiteRows<uint8_t, 3>, buildSuiteRows<uint8_t, 4> };
+	if (totalComponents <= 0xFF)
+	{
+		return narrowBuilders[max((totalComponents + 63) / 64, 1) - 1];
+	}
+	if (totalComponents <= 0xFFFF)
+	{
+		return buildSuiteRows<uint16_t, 0>;
+	}
+	return buildSuiteRows<int, 0>;
+}
+
+/**
+ *
+ *	This function shrinks the selected suite with
+ *  shrinkSuite(), keeping the rows it removed and the time
+ *  it took in stats, so the time given to shrinking can be
+ *  told apart from the time spent generating.
+ *
+ *	Returns no value(s).
+ *
+ */
+static void timedShrink(TestSuite& selectedSuite, vector<int>& factorLevels, ConstraintSet& constraints, GenerationOptions& options, ThreadPool& pool, int fixedRows, SuiteStats& stats)
+{
+	steady_clock::time_point shrinkStart = steady_clock::now();
+	stats.shrunkRows = shrinkSuite(selectedSuite, factorLevels, constraints, pool, options.seed, options.shrink, fixedRows);
+	stats.shrinkMs = duration_cast<milliseconds>(steady_clock::now() - shrinkStart).count();
+}
+
+/**
+ *
+ *	This function creates 100 test suite candidates and
+ *  randomly selects one of the suites with the fewest test
+ *  cases. This suite is representative of the best possible
+ *  outcome for this iteration of the program running. The
+ *  suites are built in parallel on the thread pool and each
+ *  one draws from its own random stream derived from the
+ *  seed. The rows of each suite are built by the
+ *  instantiation of buildSuiteRows() that pairRowBuilder()
+ *  picks for the model's size.
+ *
+ *  Instead of pooling every tied suite, only the current
+ *  best suite is kept. Each suite draws a random key and a
+ *  suite replaces the kept one if it is smaller, or equally
+ *  small with a lower key. Keeping the lowest key among the
+ *  tied suites picks each of them with equal chance (the
+ *  priority form of reservoir sampling), and because the
+ *  keys come from the suites' own streams the selected
+ *  suite only depends on the seed, not on the number of
+ *  threads or the order in which the suites finish.
+ *
+ *  Nothing is printed or written. The workspaces and the
+ *  selected suite's storage belong to the caller, so a
+ *  caller generating many models reuses the same grids and
+ *  suite memory, the suite sizes are reported through
+ *  stats, and the optional progress callback in the
+ *  options is called after every finished suite. Given a
+ *  sink in the options, the selected suite's rows are
+ *  streamed into it as soon as they are final.
+ *
+ *  A deadline or adaptive mode in the options hands the
+ *  number of attempts and candidates to an AttemptBudget,
+ *  and stats.attempts is set to the suites actually started.
+ *  With reduce set in the options, the selected suite is
+ *  shrunk by reduceSuite() before it is handed back, and
+ *  with a shrink time by shrinkSuite() after that. Seed
+ *  rows in the options start every suite and are never
+ *  touched by either.
+ *
+ *  Forbidden pairs are cleared from every grid before the
+ *  suite is built and never counted as remaining, and a
+ *  pair that turns out to be impossible under the other
+ *  constraints is given up by buildAroundPair(), so the
+ *  loop always ends. With constraints the first test case
+ *  is chosen like the others, since a fully random one
+ *  would likely break a constraint.
  *  
- *	Returns a test suite that has the fewest test cases.
+ *	Returns the caller's suite, holding the suite that has the fewest test cases.
  *
  */
-vector<TestCase> selectSuite(vector<int>& factorLevels)
+TestSuite& selectSuite(vector<int>& factorLevels, ConstraintSet& constraints, GenerationOptions& options, ThreadPool& pool, vector<SuiteWorkspace>& workspaces, TestSuite& selectedSuite, SuiteStats& stats)
 {
-	//creates a vector to hold the best candidate test suites and keeps tracks of best/worst suite sizes
-	vector<TestCase> testSuite;
-	vector<vector<TestCase>> bestSuites;
-	unsigned int smallestSuiteSize = 10000;
-	unsigned int largestSuiteSize = 0;
-	int totalCases = 0;
+	//keeps the best suite and its key, and tracks best/worst suite sizes
+	uint64_t selectedKey = 0;
+	int attemptsDone = 0;
+	atomic<int> suitesDone(0);
+	mutex selectionMutex;
+	stats.smallestSuiteSize = ~0u;
+	stats.largestSuiteSize = 0;
+	stats.totalCases = 0;
+	stats.pruned = 0;
+	stats.uncoverable = 0;
+	stats.removedRows = 0;
+	stats.shrunkRows = 0;
+	stats.shrinkMs = 0;
+	stats.keptRows = 0;
+
+	//100 attempts unless asked for otherwise, or bounded by a deadline or a plateau instead
+	AttemptBudget budget;
+	budget.start(options, 100);
+	stats.attempts = budget.maxAttempts();
+
+	//suites that fall behind the smallest finished one stop early (only without constraints, see SuiteBound)
+	SuiteBound bound;
+	bound.reset(factorLevels, 2, constraints.empty());
+
+	//a single streamed attempt writes each test case as soon as it is added, otherwise rows wait for the selection
+	bool streamRows = options.sink != NULL && stats.attempts == 1;
 
 	//find the first component for each factor and count total components in the component pool
 	vector<int> factorBegin = factorStartingNums(factorLevels);
 	int totalComponents = countComponents(factorLevels);
+	SuiteRowBuilder buildRows = pairRowBuilder(totalComponents);
 
-	//create 100 test suites for comparison
-	for (int i = 0; i != 100; i++)
+	//forbidden pairs never need covering, so they are taken out of the starting counts
+	vector<int> startingCounts = initializeUncovered(factorLevels, totalComponents);
+	if (constraints.hasPairs())
 	{
-		//ensure that no leftover test cases remain in the suite from previous iterations
-		testSuite.clear();
-
-		//initialize the suite's grid and set up vector to track number of remaining pairs for each component
-		vector<vector<int>> grid = componentGrid(factorLevels.size(), factorLevels, totalComponents);
-		vector<int> pairsRemaining = initializeUncovered(factorLevels, totalComponents);
+		CoverageGrid allowedPairs(factorLevels);
+		allowedPairs.excludeForbidden(constraints);
+		for (int c = 0; c != totalComponents; c++)
+		{
+			startingCounts[c] = allowedPairs.countUncovered(c);
+		}
+	}
 
-		//generate our first test case randomly and add it to the suite
-		TestCase firstSelection = firstTestGenerator(factorLevels.size(), factorLevels, grid);
-		addToSuite(firstSelection, grid, pairsRemaining);
-		testSuite.push_back(firstSelection);
+	//one workspace per thread, each grid is reset in place for every suite (and model) it builds
+	if (workspaces.size() < pool.slots())
+	{
+		workspaces.resize(pool.slots());
+	}
 
-		//continue generating all other test cases for the suite until no new pairs remain
-		while (*max_element(pairsRemaining.begin(), pairsRemaining.end()) != 0)
+	//builds one of the test suites for comparison
+	auto buildSuite = [&](int attempt)
+	{
+		//past the deadline only the suites needed to have one at all are built
+		if (budget.expired() && suitesDone != 0)
 		{
-			//generate a new test case randomly and add it to the suite
-			TestCase nextSelection = selectCandidate(factorLevels.size(), factorLevels, pairsRemaining, factorBegin, totalComponents, grid);
-			addToSuite(nextSelection, grid, pairsRemaining);
-			testSuite.push_back(nextSelection);
+			return;
 		}
+		AETG_ATTEMPT(attempt);
+		SuiteWorkspace& workspace = workspaces[ThreadPool::currentSlot()];
+		CoverageGrid& grid = workspace.grid;
+		UncoveredCounts& pairsRemaining = workspace.pairsRemaining;
+		TestSuite& testSuite = workspace.testSuite;
+
+		//each suite draws from its own stream so the result does not depend on which thread builds it
+		RandomStream rng(options.seed, attempt);
+		uint64_t suiteKey = rng.next();
 
-		//track total number of cases generated across suites
-		totalCases += testSuite.size();
+		int uncoverablePairs = 0;
+		int keptRows = 0;
+		bool pruned = false;
 
-		//check if the current test suite is the largest suite so far
-		if (testSuite.size() > largestSuiteSize)
+		//reset the suite's grid, the suite matrix and the counts of remaining pairs for each component
+		grid.reset(factorLevels);
+		grid.excludeForbidden(constraints);
+		pairsRemaining.reset(startingCounts);
+		workspace.worklist.clear();
+		testSuite.reset(factorLevels.size(), totalComponents);
+		long long startingPairs = pairsRemaining.uncoveredPairs();
+		if (workspace.scratch.empty())
 		{
-			largestSuiteSize = testSuite.size();
+			workspace.scratch.resize(1);
 		}
 
-		//check if the current test suite is the smallest suite so far
-		if (testSuite.size() < smallestSuiteSize)
+		//the rows are built by the instantiation picked for the model, which gives up past the deadline
+		if (!buildRows(workspace, factorLevels, factorBegin, totalComponents, constraints, options, streamRows, budget, bound, suitesDone, startingPairs, pool, rng, uncoverablePairs, keptRows, pruned))
 		{
-			smallestSuiteSize = testSuite.size();
-			//reset vector with just this test suite in it
-			bestSuites.clear();
-			bestSuites.push_back(testSuite);
+			return;
 		}
-		else if (testSuite.size() == smallestSuiteSize)
+
+		lock_guard<mutex> lock(selectionMutex);
+		AETG_PHASE(phaseSelection);
+
+		//a pruned suite is only counted, it never gets to the comparison
+		if (pruned)
 		{
-			//add to pool of best test suites
-			bestSuites.push_back(testSuite);
+			stats.pruned++;
 		}
 		else
 		{
-			//test suite is not the best candidate
-			continue;
+			//track total number of cases generated across suites
+			stats.totalCases += testSuite.size();
+
+			//check if the current test suite is the largest suite so far
+			if (testSuite.size() > stats.largestSuiteSize)
+			{
+				stats.largestSuiteSize = testSuite.size();
+			}
+
+			//keep the suite if it is the smallest so far, or ties the smallest with a lower key
+			if (testSuite.size() < stats.smallestSuiteSize || (testSuite.size() == stats.smallestSuiteSize && suiteKey < selectedKey))
+			{
+				stats.smallestSuiteSize = testSuite.size();
+				stats.uncoverable = uncoverablePairs;
+				stats.keptRows = keptRows;
+				selectedKey = suiteKey;
+				selectedSuite = testSuite;
+			}
+			bound.offer(testSuite.size());
+			suitesDone++;
+		}
+
+		//report the finished suite, still under the lock so the callbacks never overlap
+		attemptsDone++;
+		if (options.progress != NULL)
+		{
+			SuiteProgress progress = { attemptsDone, stats.attempts, stats.smallestSuiteSize };
+			options.progress(progress, options.progressData);
 		}
+	};
+
+	//run the attempts in rounds (a single one unless adaptive) until the budget says stop
+	for (int first = 0; first < budget.maxAttempts(); first += budget.roundSize())
+	{
+		if (first != 0 && !budget.nextRound(stats.smallestSuiteSize))
+		{
+			break;
+		}
+		pool.parallelFor(min(budget.roundSize(), budget.maxAttempts() - first), [&](int index)
+		{
+			buildSuite(first + index);
+		});
 	}
-	//select one of the best suites
-	vector<TestCase> selectedSuite = bestSuites[rand() % bestSuites.size()];
+	stats.attempts = attemptsDone;
 
-	//output the suite to a file named testsuite.txt
-	outputSuiteFile(selectedSuite);
-	
-	//output the information to the console in addition to the file format
-	outputSuiteAnalytics(selectedSuite, smallestSuiteSize, largestSuiteSize, totalCases);
+	//streamed rows are already out, so only a suite held in memory can be reduced
+	if (options.reduce && !streamRows)
+	{
+		stats.removedRows = reduceSuite(selectedSuite, factorLevels, 2, constraints, stats.keptRows);
+	}
+	if (options.shrink > 0 && !streamRows)
+	{
+		timedShrink(selectedSuite, factorLevels, constraints, options, pool, stats.keptRows, stats);
+	}
+
+	//the selected suite's rows are final once every attempt is done
+	if (options.sink != NULL)
+	{
+		for (int r = 0; !streamRows && r != selectedSuite.size(); r++)
+		{
+			options.sink->writeRow(selectedSuite, r);
+		}
+		options.sink->flush();
+	}
 
 	return selectedSuite;
 }
 
+/**
+ *
+ *	This function runs the last steps of an engine that
+ *  builds its pairwise suite without selectSuite()'s loop,
+ *  once the caller has set the sizes in stats:
+ *  reduceSuite() and shrinkSuite() as the options ask, the
+ *  progress callback and the sink.
+ *
+ *	Returns no value(s).
+ *
+ */
+void finishSuite(TestSuite& selectedSuite, vector<int>& factorLevels, ConstraintSet& constraints, GenerationOptions& options, ThreadPool& pool, SuiteStats& stats)
+{
+	if (options.reduce)
+	{
+		stats.removedRows = reduceSuite(selectedSuite, factorLevels, 2, constraints, 0);
+	}
+	if (options.shrink > 0)
+	{
+		timedShrink(selectedSuite, factorLevels, constraints, options, pool, 0, stats);
+	}
+	if (options.progress != NULL)
+	{
+		SuiteProgress progress = { stats.attempts, stats.attempts, stats.smallestSuiteSize };
+		options.progress(progress, options.progressData);
+	}
+	if (options.sink != NULL)
+	{
+		for (int r = 0; r != selectedSuite.size(); r++)
+		{
+			options.sink->writeRow(selectedSuite, r);
+		}
+		options.sink->flush();
+	}
+}
+
+/**
+ *
+ *	This function hands a block of buffered suite text to
+ *  an output stream, for a RowSink writing to a file or to
+ *  the console. The stream is flushed once per block so a
+ *  reader on the other end of a pipe sees each block as it
+ *  is written.
+ *
+ *	Returns no value(s).
+ *
+ */
+void writeToStream(const char* data, size_t size, void* stream)
+{
+	ostream& out = *(ostream*)stream;
+	out.write(data, size);
+	out.flush();
+}
+
 /**
  *
  *	This function sends all test cases from the selected
@@ -405,27 +946,25 @@ vector<TestCase> selectSuite(vector<int>& factorLevels)
  *	Returns no value(s).
  *
  */
-void outputSuiteFile(vector<TestCase>& selectedSuite)
+void outputSuiteFile(TestSuite& selectedSuite)
 {
 	//open a file stream to output the suite to a file called testsuite.txt
 	ofstream outputFile;
 	outputFile.open("testsuite.txt");
 
+	//the rows go through a buffered sink instead of a flush per line
+	RowSink sink(writeToStream, &outputFile);
+
 	//print the total number of test cases in the suite
-	outputFile << selectedSuite.size() << endl;
-	outputFile << endl;
+	sink.writeText(to_string(selectedSuite.size()) + "\n\n");
 
 	//print out the suite to the text file in the requested format
 	for (int i = 0; i != selectedSuite.size(); i++)
 	{
-		//print each test case line by line
-		vector<int> outputTest = selectedSuite[i].getTest();
-		for (int j = 0; j != outputTest.size(); j++)
-		{
-			outputFile << outputTest[j] << " ";
-		}
-		outputFile << endl;
+		sink.writeRow(selectedSuite, i);
 	}
+	sink.flush();
+
 	//close the file stream
 	outputFile.close();
 }
@@ -438,25 +977,58 @@ void outputSuiteFile(vector<TestCase>& selectedSuite)
  *  line. Then each test case's components are printed
  *  on their own line in a space delimited format. The
  *  smallest, largest, and average (rounded down) suite
- *  sizes are output to the console as well.
+ *  sizes are output to the console as well, along with
+ *  what the constraints left out. When the rows were
+ *  already streamed to standard output, only the
+ *  analytics are printed, and to standard error, so the
+ *  stream holds nothing but test cases.
  *
  *	Returns no value(s).
  *
  */
-void outputSuiteAnalytics(vector<TestCase>& selectedSuite, unsigned int smallestSuiteSize, unsigned int largestSuiteSize, int totalCases)
+void outputSuiteAnalytics(TestSuite& selectedSuite, SuiteStats& stats, ConstraintSet& constraints, int strength, bool streamed)
 {
-	//print the total number of test cases in the suite
-	cout << selectedSuite.size() << endl;
-	cout << endl;
-	
-	//print each test case line by line
-	for (int i = 0; i != selectedSuite.size(); i++)
+	ostream& console = streamed ? cerr : cout;
+	if (!streamed)
 	{
-		selectedSuite[i].printTestCase();
+		//print the total number of test cases in the suite and each test case line by line
+		RowSink sink(writeToStream, &cout);
+		sink.writeText(to_string(selectedSuite.size()) + "\n\n");
+		for (int i = 0; i != selectedSuite.size(); i++)
+		{
+			sink.writeRow(selectedSuite, i);
+		}
 	}
+
 	//print analytics to the console
-	cout << "********** Analytics **********" << endl;
-	cout << "Smallest suite size: " << smallestSuiteSize << endl;
-	cout << "Largest suite size: " << largestSuiteSize << endl;
-	cout << "Average suite size (rounded down): " << totalCases / 100 << endl;
+	console << "********** Analytics **********" << endl;
+	console << "Smallest suite size: " << stats.smallestSuiteSize << endl;
+	//pruned suites were never finished, so the sizes of the others are labelled as such
+	console << "Largest finished suite size: " << stats.largestSuiteSize << endl;
+	console << "Average finished suite size (rounded down): " << stats.totalCases / (stats.attempts - stats.pruned) << endl;
+	console << "Suites compared: " << stats.attempts << endl;
+	if (stats.pruned != 0)
+	{
+		console << "Suites given up as unable to beat the smallest: " << stats.pruned << endl;
+	}
+	if (stats.keptRows != 0)
+	{
+		console << "Test cases kept from the existing suite: " << stats.keptRows << endl;
+	}
+	if (stats.removedRows != 0)
+	{
+		console << "Test cases removed by reduction: " << stats.removedRows << endl;
+	}
+	if (stats.shrunkRows != 0)
+	{
+		console << "Test cases removed by shrinking: " << stats.shrunkRows << endl;
+	}
+	if (strength == 2 && constraints.hasPairs())
+	{
+		console << "Forbidden pairs excluded: " << constraints.forbiddenPairs() << endl;
+	}
+	if (stats.uncoverable != 0)
+	{
+		console << (strength == 2 ? "Pairs" : "Tuples") << " impossible under the constraints: " << stats.uncoverable << endl;
+	}
 }
\ No newline at end of file
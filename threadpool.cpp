@@ -0,0 +1,265 @@
+#include "threadpool.h"
+#include <algorithm>
+
+using namespace std;
+
+//slot of the thread currently running, workers are numbered from 1
+static thread_local int threadSlot = 0;
+
+/**
+ *
+ *	This data structure holds the shared state of a single
+ *  parallelFor() call. Loop indices are claimed with an
+ *  atomic counter, so helpers that start late simply find
+ *  nothing left to claim and return.
+ *
+ */
+struct ParallelJob
+{
+	void (*call)(const void*, int);
+	const void* body;
+	int count;
+	atomic<int> next;
+	atomic<int> finished;
+	mutex doneMutex;
+	condition_variable doneReady;
+};
+
+/**
+ *
+ *	This function claims loop indices from a job one at a
+ *  time and runs the loop body for each of them until no
+ *  indices remain. The thread that finishes the last index
+ *  wakes up the caller of parallelFor().
+ *
+ *	Returns no value(s).
+ *
+ */
+static void runJob(ParallelJob& job)
+{
+	int index = job.next++;
+	while (index < job.count)
+	{
+		job.call(job.body, index);
+
+		//the last finished index releases the waiting caller
+		if (++job.finished == job.count)
+		{
+			lock_guard<mutex> lock(job.doneMutex);
+			job.doneReady.notify_all();
+		}
+		index = job.next++;
+	}
+}
+
+ThreadPool::ThreadPool(int threads)
+{
+	stopping = false;
+	pendingTasks = 0;
+
+	//the calling thread also runs loop bodies, so one fewer worker is needed
+	if (threads <= 0)
+	{
+		threads = max(1, (int)thread::hardware_concurrency());
+	}
+	for (int i = 0; i != threads; i++)
+	{
+		queues.emplace_back(new TaskQueue());
+	}
+	for (int i = 1; i < threads; i++)
+	{
+		workers.emplace_back(&ThreadPool::workerLoop, this, i);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		lock_guard<mutex> lock(sleepMutex);
+		stopping = true;
+	}
+	taskReady.notify_all();
+	for (int i = 0; i != workers.size(); i++)
+	{
+		workers[i].join();
+	}
+}
+
+int ThreadPool::currentSlot()
+{
+	return threadSlot;
+}
+
+/**
+ *
+ *	This function finds the next task for a worker. The
+ *  worker's own deque is checked first (newest task first),
+ *  then the other slots are visited in turn and their
+ *  oldest task is stolen.
+ *
+ *	Returns true if a task was found.
+ *
+ */
+bool ThreadPool::takeTask(int slot, shared_ptr<ParallelJob>& task)
+{
+	{
+		TaskQueue& own = *queues[slot];
+		lock_guard<mutex> lock(own.queueMutex);
+		if (own.count != 0)
+		{
+			own.count--;
+			task = move(own.ring[(own.head + own.count) % own.ring.size()]);
+			pendingTasks--;
+			return true;
+		}
+	}
+	for (int i = 1; i != queues.size(); i++)
+	{
+		TaskQueue& victim = *queues[(slot + i) % queues.size()];
+		lock_guard<mutex> lock(victim.queueMutex);
+		if (victim.count != 0)
+		{
+			task = move(victim.ring[victim.head]);
+			victim.head = (victim.head + 1) % victim.ring.size();
+			victim.count--;
+			pendingTasks--;
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ *
+ *	This function hands out a job object for a new loop.
+ *  A cached job is reused once nothing else refers to it,
+ *  which means every helper queued for its last loop has
+ *  been taken and has finished.
+ *
+ *	Returns a job that only the caller refers to.
+ *
+ */
+shared_ptr<ParallelJob> ThreadPool::reuseJob(TaskQueue& queue)
+{
+	lock_guard<mutex> lock(queue.cacheMutex);
+	for (int i = 0; i != queue.jobCache.size(); i++)
+	{
+		if (queue.jobCache[i].use_count() == 1)
+		{
+			//pairs with the release done by the last helper dropping its reference
+			atomic_thread_fence(memory_order_acquire);
+			return queue.jobCache[i];
+		}
+	}
+	queue.jobCache.push_back(make_shared<ParallelJob>());
+	return queue.jobCache.back();
+}
+
+/**
+ *
+ *	This function is run by every worker thread. It runs
+ *  its own or stolen tasks and sleeps while no slot has
+ *  any queued work, until the pool is destroyed.
+ *
+ *	Returns no value(s).
+ *
+ */
+void ThreadPool::workerLoop(int slot)
+{
+	threadSlot = slot;
+	while (true)
+	{
+		shared_ptr<ParallelJob> task;
+		if (takeTask(slot, task))
+		{
+			runJob(*task);
+			continue;
+		}
+
+		//nothing to run anywhere, wait until a task is queued
+		unique_lock<mutex> lock(sleepMutex);
+		taskReady.wait(lock, [this] { return stopping || pendingTasks > 0; });
+		if (stopping)
+		{
+			return;
+		}
+	}
+}
+
+/**
+ *
+ *	This function runs a loop body for every index in
+ *  [0, count). Helper tasks are queued on the calling
+ *  thread's own deque for idle workers to steal, while the
+ *  calling thread claims indices as well. A loop started
+ *  from inside another loop is finished by its caller if
+ *  every other worker is busy, so nothing waits on the pool.
+ *
+ *	Returns no value(s).
+ *
+ */
+void ThreadPool::parallelFor(int count, void (*call)(const void*, int), const void* body)
+{
+	if (count <= 0)
+	{
+		return;
+	}
+
+	//the job is shared with the helpers since they may start after this call returns
+	TaskQueue& own = *queues[threadSlot];
+	shared_ptr<ParallelJob> job = reuseJob(own);
+	job->call = call;
+	job->body = body;
+	job->count = count;
+	job->next = 0;
+	job->finished = 0;
+
+	//invite one helper per worker, never more than there are extra indices
+	int helpers = min(count - 1, (int)workers.size());
+	if (helpers > 0)
+	{
+		{
+			lock_guard<mutex> lock(own.queueMutex);
+
+			//grow the ring when full, unwrapping it so the oldest job is first again
+			if (own.count + helpers > own.ring.size())
+			{
+				vector<shared_ptr<ParallelJob>> grown(max(2 * own.ring.size(), (size_t)(own.count + helpers)));
+				for (int i = 0; i != own.count; i++)
+				{
+					grown[i] = move(own.ring[(own.head + i) % own.ring.size()]);
+				}
+				own.ring.swap(grown);
+				own.head = 0;
+			}
+			for (int i = 0; i != helpers; i++)
+			{
+				own.ring[(own.head + own.count) % own.ring.size()] = job;
+				own.count++;
+			}
+		}
+		{
+			lock_guard<mutex> lock(sleepMutex);
+			pendingTasks += helpers;
+		}
+		taskReady.notify_all();
+	}
+
+	//work through the loop on this thread too
+	runJob(*job);
+
+	//helpers nobody picked up are still on top of this thread's deque, take them back
+	{
+		lock_guard<mutex> lock(own.queueMutex);
+		while (own.count != 0 && own.ring[(own.head + own.count - 1) % own.ring.size()] == job)
+		{
+			own.count--;
+			own.ring[(own.head + own.count) % own.ring.size()].reset();
+			pendingTasks--;
+		}
+	}
+
+	//wait for indices still held by helpers
+	unique_lock<mutex> lock(job->doneMutex);
+	job->doneReady.wait(lock, [&job] { return job->finished == job->count; });
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+
+/**
+ *
+ *  This class keeps a fixed set of worker threads alive for
+ *  the whole run so that suite generation does not pay for
+ *  thread creation on every call. Work is handed out with
+ *  parallelFor(), where the calling thread takes part in the
+ *  loop itself. Every thread that can run loop bodies owns
+ *  a slot number so callers can keep per-thread state in a
+ *  plain vector indexed by currentSlot().
+ *
+ *  Each slot has its own task deque. A thread pushes and
+ *  pops its own tasks at the back, while idle workers steal
+ *  from the front of other slots. Loops started from inside
+ *  another loop (candidates inside a suite) are therefore
+ *  only picked up by threads that have nothing else to do,
+ *  and the pool never runs more threads than it was given.
+ *  Queues and loop jobs are recycled, so starting a loop
+ *  does not allocate once the pool has warmed up.
+ *
+ */
+struct ParallelJob;
+
+class ThreadPool
+{
+private:
+	//ring buffer of queued jobs plus the jobs this slot has started before, ready for reuse
+	struct TaskQueue
+	{
+		std::vector<std::shared_ptr<ParallelJob>> ring;
+		int head;
+		int count;
+		std::mutex queueMutex;
+		std::vector<std::shared_ptr<ParallelJob>> jobCache;
+		std::mutex cacheMutex;
+
+		TaskQueue()
+		{
+			head = 0;
+			count = 0;
+		}
+	};
+
+	std::vector<std::thread> workers;
+	std::vector<std::unique_ptr<TaskQueue>> queues;
+	std::atomic<int> pendingTasks;
+	std::mutex sleepMutex;
+	std::condition_variable taskReady;
+	bool stopping;
+
+	void workerLoop(int slot);
+	bool takeTask(int slot, std::shared_ptr<ParallelJob>& task);
+	std::shared_ptr<ParallelJob> reuseJob(TaskQueue& queue);
+public:
+	//creates a pool that runs loops on the given number of threads (0 picks one per hardware thread)
+	ThreadPool(int threads);
+	~ThreadPool();
+
+	//returns how many threads can run loop bodies at once, including the calling thread
+	int slots() const
+	{
+		return workers.size() + 1;
+	}
+
+	//returns the slot of the calling thread (0 for any thread outside the pool)
+	static int currentSlot();
+
+	//runs body(i) for every i in [0, count) and returns once all of them have finished
+	template <typename Body>
+	void parallelFor(int count, const Body& body)
+	{
+		//the body is passed on by address, so no std::function (and no allocation) is needed
+		parallelFor(count, &callBody<Body>, &body);
+	}
+
+	void parallelFor(int count, void (*call)(const void*, int), const void* body);
+private:
+	template <typename Body>
+	static void callBody(const void* body, int index)
+	{
+		(*(const Body*)body)(index);
+	}
+};
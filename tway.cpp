@@ -0,0 +1,695 @@
+#include "aetgfunctions.h"
+#include <algorithm>
+#include <mutex>
+#include <atomic>
+
+using namespace std;
+
+//the highest coverage strength supported, keeps the per-tuple scratch arrays on the stack
+static const int maxStrength = 6;
+
+//number of suites and candidates per test case used for strengths above 2
+static const int tWayAttempts = 10;
+static const int tWayCandidates = 20;
+
+//how many times a test case is built around a tuple before the tuple is given up as impossible
+static const int tupleRetries = 20;
+
+//candidates are only scored in parallel once t-subsets x components reaches this size
+static const long long parallelTupleWork = 4096;
+
+/**
+ *
+ *	This function counts how many t-way tuples each
+ *  component starts out in. A component of factor f is in
+ *  one tuple for every way of choosing t-1 other factors
+ *  and one level from each of them, which is the
+ *  elementary symmetric polynomial e(t-1) over the levels
+ *  of all other factors.
+ *
+ *	Returns a vector containing a count of uncovered tuples
+ *  remaining for each component.
+ *
+ */
+vector<int> initializeUncoveredTuples(vector<int>& levels, int strength)
+{
+	vector<int> uncoveredCount;
+	for (int f = 0; f != levels.size(); f++)
+	{
+		//e[k] = sum over k-subsets of the other factors of the product of their levels
+		vector<long long> e(strength, 0);
+		e[0] = 1;
+		for (int g = 0; g != levels.size(); g++)
+		{
+			if (g == f)
+			{
+				continue;
+			}
+			for (int k = strength - 1; k >= 1; k--)
+			{
+				e[k] += e[k - 1] * levels[g];
+			}
+		}
+		uncoveredCount.insert(uncoveredCount.end(), levels[f], (int)e[strength - 1]);
+	}
+	return uncoveredCount;
+}
+
+/**
+ *
+ *	This function creates a test case for t-way coverage
+ *  the same way testGenerator() does for pairs. The first
+ *  component is one of the components in the most uncovered
+ *  tuples and completeTestCaseTWay() fills in the rest.
+ *
+ *	Returns no value(s), the test case is filled in place.
+ *
+ */
+void testGeneratorTWay(TestCase& testCase, vector<int>& levels, vector<int>& factorBegin, TupleCoverage& coverage, UncoveredCounts& tuplesRemaining, ConstraintSet& constraints, RandomStream& rng, CandidateScratch& scratch)
+{
+	testCase.reset(levels.size());
+
+	//start from one of the components in the most uncovered tuples
+	int selectedComponent = tuplesRemaining.best(rng.below(tuplesRemaining.bestCount()));
+	testCase.setComponent(coverage.factorOf(selectedComponent), selectedComponent);
+	completeTestCaseTWay(testCase, levels, factorBegin, coverage, tuplesRemaining, constraints, rng, scratch);
+}
+
+/**
+ *
+ *	This function fills in every factor of a test case that
+ *  does not have a component yet, in a random factor order.
+ *  Each factor's levels are scored by the tuples that
+ *  choosing them would complete: every (t-1)-subset of the
+ *  factors selected so far, plus the current factor. Only
+ *  those tuples are looked at, since all other tuples of
+ *  the test case are already decided. The selected factors
+ *  are kept sorted, so each subset is already in order and
+ *  the current factor is merged in.
+ *
+ *  Components that break a constraint are left out of the
+ *  pool, and if every component of a factor is ruled out
+ *  the test case is marked with -1 new tuples. Tuples made
+ *  only of components placed beforehand are not counted.
+ *
+ *	Returns true if every factor could be filled in.
+ *
+ */
+bool completeTestCaseTWay(TestCase& testCase, vector<int>& levels, vector<int>& factorBegin, TupleCoverage& coverage, UncoveredCounts& tuplesRemaining, ConstraintSet& constraints, RandomStream& rng, CandidateScratch& scratch)
+{
+	vector<int>& factorOrder = scratch.factorOrder;
+	vector<int>& selectedFactors = scratch.selectedFactors;
+	vector<int>& maxPairs = scratch.maxPairs;
+	vector<int>& levelScores = scratch.levelScores;
+	int factors = levels.size();
+	int strength = coverage.getStrength();
+	int totalNewTuples = 0;
+	factorOrder.resize(factors);
+	selectedFactors.clear();
+	levelScores.resize(*max_element(levels.begin(), levels.end()));
+
+	//the factors placed beforehand are already in factor order
+	for (int f = 0; f != factors; f++)
+	{
+		if (testCase.atIndex(f) >= 0)
+		{
+			selectedFactors.push_back(f);
+		}
+	}
+
+	//randomize order for factor selection
+	factorShuffle(factorOrder, rng);
+
+	for (int i = 0; i != factors; i++)
+	{
+		int currentFactor = factorOrder[i];
+		int currentLevels = levels[currentFactor];
+		if (testCase.atIndex(currentFactor) >= 0)
+		{
+			continue;
+		}
+		int currentMaxTuples = 0;
+		fill(levelScores.begin(), levelScores.begin() + currentLevels, 0);
+
+		//walk every (t-1)-subset of the selected factors, in sorted order
+		int others = strength - 1;
+		int pick[maxStrength];
+		for (int j = 0; j != others; j++)
+		{
+			pick[j] = j;
+		}
+		while (others <= selectedFactors.size())
+		{
+			//merge the current factor into the subset in factor order, building the subset's rank
+			//and the mixed-radix index (current factor at level 0) and the step between its levels
+			uint64_t rank = 0;
+			uint64_t base = 0;
+			uint64_t currentStride = 1;
+			bool merged = false;
+			int position = 0;
+			for (int j = 0; j != others; j++)
+			{
+				int factor = selectedFactors[pick[j]];
+				if (!merged && currentFactor < factor)
+				{
+					rank += coverage.chooseUnchecked(currentFactor, ++position);
+					base *= currentLevels;
+					merged = true;
+				}
+				rank += coverage.chooseUnchecked(factor, ++position);
+				base = base * levels[factor] + testCase.atIndex(factor) - factorBegin[factor];
+				if (merged)
+				{
+					currentStride *= levels[factor];
+				}
+			}
+			if (!merged)
+			{
+				rank += coverage.chooseUnchecked(currentFactor, ++position);
+				base *= currentLevels;
+			}
+			base += coverage.subsetStart(rank);
+			AETG_COUNT(counterGridProbes, currentLevels);
+			for (int l = 0; l != currentLevels; l++)
+			{
+				if (coverage.isUncovered(base + l * currentStride))
+				{
+					levelScores[l]++;
+				}
+			}
+
+			//advance to the next (t-1)-subset
+			int j = others - 1;
+			while (j >= 0 && pick[j] == selectedFactors.size() - others + j)
+			{
+				j--;
+			}
+			if (j < 0)
+			{
+				break;
+			}
+			pick[j]++;
+			for (int k = j + 1; k != others; k++)
+			{
+				pick[k] = pick[k - 1] + 1;
+			}
+		}
+
+		//pool the levels that complete the most uncovered tuples, breaking ties by the level's
+		//remaining tuples overall (the only signal for the first t-1 factors), then pick one at random
+		maxPairs.clear();
+		int currentMaxRemaining = -1;
+		for (int l = 0; l != currentLevels; l++)
+		{
+			int remaining = tuplesRemaining[factorBegin[currentFactor] + l];
+			if (!constraints.empty() && !constraints.allows(factorBegin[currentFactor] + l, testCase))
+			{
+				AETG_COUNT(counterConstraintRejects, 1);
+				continue;
+			}
+			if (levelScores[l] > currentMaxTuples || (levelScores[l] == currentMaxTuples && remaining > currentMaxRemaining))
+			{
+				currentMaxTuples = levelScores[l];
+				currentMaxRemaining = remaining;
+				maxPairs.clear();
+				maxPairs.push_back(factorBegin[currentFactor] + l);
+			}
+			else if (levelScores[l] == currentMaxTuples && remaining == currentMaxRemaining)
+			{
+				maxPairs.push_back(factorBegin[currentFactor] + l);
+			}
+		}
+
+		//every component of the factor breaks a constraint, so this test case cannot be finished
+		if (maxPairs.empty())
+		{
+			testCase.setNewPairs(-1);
+			return false;
+		}
+		AETG_COUNT(counterLevelTies, maxPairs.size() - 1);
+		testCase.setComponent(currentFactor, maxPairs[rng.below(maxPairs.size())]);
+		totalNewTuples += currentMaxTuples;
+
+		//keep the selected factors sorted for the next factor's subsets
+		selectedFactors.insert(upper_bound(selectedFactors.begin(), selectedFactors.end(), currentFactor), currentFactor);
+	}
+	//update the test case to contain the total number of new tuples created
+	testCase.setNewPairs(totalNewTuples);
+	return true;
+}
+
+/**
+ *
+ *	This function creates the candidate test cases for one
+ *  row of a t-way suite, in parallel for larger models, and
+ *  selects one of the candidates that cover the most new
+ *  tuples. Like selectCandidate(), each candidate draws
+ *  from its own stream so the result does not depend on
+ *  the number of threads.
+ *
+ *	Returns the candidate slot holding the selected test case.
+ *
+ */
+TestCase& selectCandidateTWay(vector<TestCase>& generated, vector<CandidateScratch>& scratch, int candidates, vector<int>& levels, vector<int>& factorBegin, TupleCoverage& coverage, UncoveredCounts& tuplesRemaining, ConstraintSet& constraints, RandomStream& rng, ThreadPool& pool)
+{
+	AETG_PHASE(phaseCandidates);
+	AETG_COUNT(counterCandidates, candidates);
+	if (generated.size() < candidates)
+	{
+		generated.resize(candidates);
+		scratch.resize(candidates);
+	}
+
+	//every candidate gets its own stream derived from the suite's stream
+	uint64_t candidateSeed = rng.next();
+	auto buildCandidate = [&](int i)
+	{
+		RandomStream candidateRng(candidateSeed, i);
+		testGeneratorTWay(generated[i], levels, factorBegin, coverage, tuplesRemaining, constraints, candidateRng, scratch[i]);
+	};
+
+	//only share the candidates out when each one is worth a task
+	if ((long long)coverage.subsetCount() * factorBegin.size() >= parallelTupleWork)
+	{
+		pool.parallelFor(candidates, buildCandidate);
+	}
+	else
+	{
+		for (int i = 0; i != candidates; i++)
+		{
+			buildCandidate(i);
+		}
+	}
+	return pickCandidate(generated, candidates, rng);
+}
+
+/**
+ *
+ *	This function marks every t-way tuple of a test case as
+ *  covered. Only the C(factors, t) tuples of this one row
+ *  are touched, and the remaining-tuple counts of their
+ *  components are lowered for every tuple that was new.
+ *
+ *	Returns no value(s).
+ *
+ */
+void addToSuiteTWay(const TestCase& currentTestCase, vector<int>& factorBegin, TupleCoverage& coverage, UncoveredCounts& tuplesRemaining)
+{
+	int strength = coverage.getStrength();
+	int factors = currentTestCase.testSize();
+	int subset[maxStrength];
+	int tupleLevels[maxStrength];
+	int components[maxStrength];
+	AETG_PHASE(phaseAddToSuite);
+	AETG_COUNT(counterGridProbes, coverage.subsetCount());
+	for (int i = 0; i != strength; i++)
+	{
+		subset[i] = i;
+	}
+
+	//walk every t-subset of the factors in lexicographic order
+	while (strength <= factors)
+	{
+		for (int i = 0; i != strength; i++)
+		{
+			components[i] = currentTestCase.atIndex(subset[i]);
+			tupleLevels[i] = components[i] - factorBegin[subset[i]];
+		}
+		uint64_t index = coverage.tupleIndex(subset, tupleLevels);
+		if (coverage.isUncovered(index))
+		{
+			coverage.cover(index);
+			tuplesRemaining.coverTuple(components, strength);
+		}
+
+		int i = strength - 1;
+		while (i >= 0 && subset[i] == factors - strength + i)
+		{
+			i--;
+		}
+		if (i < 0)
+		{
+			break;
+		}
+		subset[i]++;
+		for (int j = i + 1; j != strength; j++)
+		{
+			subset[j] = subset[j - 1] + 1;
+		}
+	}
+}
+
+/**
+ *
+ *	This function marks every tuple that holds a forbidden
+ *  pair or a forbidden combination as covered and takes
+ *  those tuples out of the starting counts, so they are
+ *  never looked for. It walks every tuple once, which is
+ *  only done a single time per run.
+ *
+ *	Returns no value(s).
+ *
+ */
+void excludeForbiddenTuples(TupleCoverage& coverage, vector<int>& startingCounts, vector<int>& factorBegin, ConstraintSet& constraints)
+{
+	int strength = coverage.getStrength();
+	int factors = factorBegin.size();
+	int subset[maxStrength];
+	int components[maxStrength];
+	TestCase partial(factors);
+	for (int i = 0; i != strength; i++)
+	{
+		subset[i] = i;
+	}
+
+	//walk every t-subset of the factors in lexicographic order
+	while (strength <= factors)
+	{
+		uint64_t rank = coverage.subsetRank(subset);
+		for (int i = 0; i != strength; i++)
+		{
+			components[i] = factorBegin[subset[i]];
+		}
+
+		//walk the subset's block in mixed radix, the last factor changing fastest
+		for (uint64_t index = coverage.subsetStart(rank); index != coverage.subsetStart(rank + 1); index++)
+		{
+			bool forbidden = false;
+			for (int i = 0; i != strength && !forbidden; i++)
+			{
+				for (int j = i + 1; j != strength && !forbidden; j++)
+				{
+					forbidden = constraints.isForbiddenPair(components[i], components[j]);
+				}
+			}
+			if (!forbidden && constraints.hasTuples())
+			{
+				for (int i = 0; i != strength; i++)
+				{
+					partial.setComponent(subset[i], components[i]);
+				}
+				for (int i = 0; i != strength && !forbidden; i++)
+				{
+					forbidden = constraints.completesTuple(components[i], partial);
+				}
+				for (int i = 0; i != strength; i++)
+				{
+					partial.setComponent(subset[i], -1);
+				}
+			}
+			if (forbidden)
+			{
+				coverage.cover(index);
+				for (int i = 0; i != strength; i++)
+				{
+					startingCounts[components[i]]--;
+				}
+			}
+
+			//step to the next combination of levels
+			for (int i = strength - 1; i >= 0; i--)
+			{
+				if (++components[i] != factorBegin[subset[i]] + coverage.levelsIn(subset[i]))
+				{
+					break;
+				}
+				components[i] = factorBegin[subset[i]];
+			}
+		}
+
+		//advance to the next t-subset
+		int i = strength - 1;
+		while (i >= 0 && subset[i] == factors - strength + i)
+		{
+			i--;
+		}
+		if (i < 0)
+		{
+			break;
+		}
+		subset[i]++;
+		for (int j = i + 1; j != strength; j++)
+		{
+			subset[j] = subset[j - 1] + 1;
+		}
+	}
+}
+
+/**
+ *
+ *	This function is used when none of the candidates
+ *  covers a new tuple, the t-way version of
+ *  buildAroundPair(). It tries to build a valid test case
+ *  around the first uncovered tuple, and if that keeps
+ *  failing the tuple is marked as covered and counted as
+ *  impossible under the constraints.
+ *
+ *	Returns true if the test case holds a valid row that covers the tuple.
+ *
+ */
+bool buildAroundTuple(TestCase& testCase, vector<int>& levels, vector<int>& factorBegin, TupleCoverage& coverage, UncoveredCounts& tuplesRemaining, ConstraintSet& constraints, RandomStream& rng, CandidateScratch& scratch, int& uncoverableTuples)
+{
+	AETG_PHASE(phaseBuildAround);
+	int strength = coverage.getStrength();
+	int tupleFactors[maxStrength];
+	int tupleLevels[maxStrength];
+	int components[maxStrength];
+	uint64_t index = coverage.nextUncovered(0);
+	coverage.decodeTuple(index, tupleFactors, tupleLevels);
+	for (int i = 0; i != strength; i++)
+	{
+		components[i] = factorBegin[tupleFactors[i]] + tupleLevels[i];
+	}
+
+	for (int attempt = 0; attempt != tupleRetries; attempt++)
+	{
+		testCase.reset(levels.size());
+		for (int i = 0; i != strength; i++)
+		{
+			testCase.setComponent(tupleFactors[i], components[i]);
+		}
+		if (completeTestCaseTWay(testCase, levels, factorBegin, coverage, tuplesRemaining, constraints, rng, scratch))
+		{
+			return true;
+		}
+	}
+
+	//no test case can hold the tuple, stop looking for it
+	coverage.cover(index);
+	tuplesRemaining.coverTuple(components, strength);
+	uncoverableTuples++;
+	return false;
+}
+
+/**
+ *
+ *	This function creates t-way covering suites and selects
+ *  one with the fewest test cases, the same way
+ *  selectSuite() does for pairs. Fewer suites and fewer
+ *  candidates per test case are built than for pairs,
+ *  since every candidate has to look at C(factors, t-1)
+ *  tuples per factor instead of one pair per factor.
+ *  Tuples ruled out by the constraints are worked out once
+ *  and every suite starts from a copy of that coverage.
+ *
+ *	Returns the caller's suite, holding the suite that has the fewest test cases.
+ *
+ */
+TestSuite& selectSuiteTWay(vector<int>& factorLevels, int strength, ConstraintSet& constraints, GenerationOptions& options, ThreadPool& pool, vector<TupleWorkspace>& workspaces, TestSuite& selectedSuite, SuiteStats& stats)
+{
+	uint64_t selectedKey = 0;
+	int attemptsDone = 0;
+	atomic<int> suitesDone(0);
+	mutex selectionMutex;
+	stats.smallestSuiteSize = ~0u;
+	stats.largestSuiteSize = 0;
+	stats.totalCases = 0;
+	stats.pruned = 0;
+	stats.uncoverable = 0;
+	stats.removedRows = 0;
+	stats.shrunkRows = 0;
+	stats.shrinkMs = 0;
+	stats.keptRows = 0;
+	int seedRows = options.seedRows == NULL ? 0 : options.seedRows->size();
+
+	AttemptBudget budget;
+	budget.start(options, tWayAttempts);
+	stats.attempts = budget.maxAttempts();
+	SuiteBound bound;
+	bound.reset(factorLevels, strength, constraints.empty());
+
+	//a single streamed attempt writes each test case as soon as it is added, otherwise rows wait for the selection
+	bool streamRows = options.sink != NULL && stats.attempts == 1;
+
+	vector<int> factorBegin = factorStartingNums(factorLevels);
+	int totalComponents = countComponents(factorLevels);
+	vector<int> startingCounts = initializeUncoveredTuples(factorLevels, strength);
+
+	//tuples holding a forbidden combination never need covering
+	TupleCoverage allowedTuples;
+	allowedTuples.reset(factorLevels, strength);
+	if (!constraints.empty())
+	{
+		excludeForbiddenTuples(allowedTuples, startingCounts, factorBegin, constraints);
+	}
+
+	//one workspace per thread, each tuple bitset is reset in place for every suite (and model) it builds
+	if (workspaces.size() < pool.slots())
+	{
+		workspaces.resize(pool.slots());
+	}
+
+	auto buildSuite = [&](int attempt)
+	{
+		//past the deadline only the suites needed to have one at all are built
+		if (budget.expired() && suitesDone != 0)
+		{
+			return;
+		}
+		AETG_ATTEMPT(attempt);
+		TupleWorkspace& workspace = workspaces[ThreadPool::currentSlot()];
+		TupleCoverage& coverage = workspace.coverage;
+		UncoveredCounts& tuplesRemaining = workspace.tuplesRemaining;
+		TestSuite& testSuite = workspace.testSuite;
+
+		//each suite draws from its own stream so the result does not depend on which thread builds it
+		RandomStream rng(options.seed, attempt);
+		uint64_t suiteKey = rng.next();
+		int uncoverableTuples = 0;
+		int keptRows = 0;
+		bool pruned = false;
+
+		coverage = allowedTuples;
+		tuplesRemaining.reset(startingCounts, strength);
+		testSuite.reset(factorLevels.size(), totalComponents);
+		long long startingTuples = tuplesRemaining.uncoveredPairs();
+		if (workspace.scratch.empty())
+		{
+			workspace.scratch.resize(1);
+		}
+
+		//the rows of an existing suite come first, their missing factors chosen by the new tuples they make
+		for (int r = 0; r != seedRows; r++)
+		{
+			AETG_PHASE(phaseSeedRows);
+			TestCase& seedCase = workspace.seedSelection;
+			bool filled = false;
+			for (int retry = 0; retry != tupleRetries && !filled; retry++)
+			{
+				seedCase = (*options.seedRows)[r];
+				filled = completeTestCaseTWay(seedCase, factorLevels, factorBegin, coverage, tuplesRemaining, constraints, rng, workspace.scratch[0]);
+			}
+			if (!filled)
+			{
+				continue;
+			}
+			addToSuiteTWay(seedCase, factorBegin, coverage, tuplesRemaining);
+			AETG_ROW(seedCase.newPairsCount());
+			testSuite.appendRow(seedCase);
+			keptRows++;
+			if (streamRows)
+			{
+				options.sink->writeRow(seedCase);
+			}
+		}
+
+		//keep adding the best candidate until every tuple is covered
+		while (tuplesRemaining.uncoveredPairs() != 0)
+		{
+			if (budget.expired() && suitesDone != 0)
+			{
+				return;
+			}
+
+			//give up on a suite that can no longer beat the smallest finished one
+			if (bound.cannotBeat(testSuite.size(), tuplesRemaining))
+			{
+				pruned = true;
+				break;
+			}
+			int candidates = budget.candidates(tWayCandidates, tuplesRemaining.uncoveredPairs(), startingTuples);
+			TestCase& nextSelection = selectCandidateTWay(workspace.candidates, workspace.scratch, candidates, factorLevels, factorBegin, coverage, tuplesRemaining, constraints, rng, pool);
+
+			//when no candidate makes progress, build a test case around one uncovered tuple instead
+			if (nextSelection.newPairsCount() <= 0 && !buildAroundTuple(nextSelection, factorLevels, factorBegin, coverage, tuplesRemaining, constraints, rng, workspace.scratch[0], uncoverableTuples))
+			{
+				continue;
+			}
+			addToSuiteTWay(nextSelection, factorBegin, coverage, tuplesRemaining);
+			AETG_ROW(nextSelection.newPairsCount());
+			testSuite.appendRow(nextSelection);
+			if (streamRows)
+			{
+				options.sink->writeRow(nextSelection);
+			}
+		}
+
+		lock_guard<mutex> lock(selectionMutex);
+		AETG_PHASE(phaseSelection);
+
+		//a pruned suite is only counted, it never gets to the comparison
+		if (pruned)
+		{
+			stats.pruned++;
+		}
+		else
+		{
+			stats.totalCases += testSuite.size();
+			if (testSuite.size() > stats.largestSuiteSize)
+			{
+				stats.largestSuiteSize = testSuite.size();
+			}
+
+			//keep the suite if it is the smallest so far, or ties the smallest with a lower key
+			if (testSuite.size() < stats.smallestSuiteSize || (testSuite.size() == stats.smallestSuiteSize && suiteKey < selectedKey))
+			{
+				stats.smallestSuiteSize = testSuite.size();
+				stats.uncoverable = uncoverableTuples;
+				stats.keptRows = keptRows;
+				selectedKey = suiteKey;
+				selectedSuite = testSuite;
+			}
+			bound.offer(testSuite.size());
+			suitesDone++;
+		}
+
+		//report the finished suite, still under the lock so the callbacks never overlap
+		attemptsDone++;
+		if (options.progress != NULL)
+		{
+			SuiteProgress progress = { attemptsDone, stats.attempts, stats.smallestSuiteSize };
+			options.progress(progress, options.progressData);
+		}
+	};
+
+	for (int first = 0; first < budget.maxAttempts(); first += budget.roundSize())
+	{
+		if (first != 0 && !budget.nextRound(stats.smallestSuiteSize))
+		{
+			break;
+		}
+		pool.parallelFor(min(budget.roundSize(), budget.maxAttempts() - first), [&](int index)
+		{
+			buildSuite(first + index);
+		});
+	}
+	stats.attempts = attemptsDone;
+
+	//streamed rows are already out, so only a suite held in memory can be reduced
+	if (options.reduce && !streamRows)
+	{
+		stats.removedRows = reduceSuite(selectedSuite, factorLevels, strength, constraints, stats.keptRows);
+	}
+
+	//the selected suite's rows are final once every attempt is done
+	if (options.sink != NULL)
+	{
+		for (int r = 0; !streamRows && r != selectedSuite.size(); r++)
+		{
+			options.sink->writeRow(selectedSuite, r);
+		}
+		options.sink->flush();
+	}
+
+	return selectedSuite;
+}
\ No newline at end of file
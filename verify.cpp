@@ -0,0 +1,518 @@
+#include "aetg.h"
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <cstdlib>
+
+using namespace std;
+
+//the highest coverage strength supported, keeps the per-tuple arrays on the stack
+static const int maxStrength = 6;
+
+//rows read and checked together once the growth curve is past its doubling start
+static const int chunkRows = 65536;
+
+//each thread gets this many slices of a chunk, so slices that take longer even out
+static const int slicesPerThread = 4;
+
+//how many missing tuples are printed to the console, the report file lists all of them
+static const int listedTuples = 20;
+
+//the state of a text suite file being read a chunk at a time
+struct TextSuiteSource
+{
+	ifstream input;
+	string fileName;
+	Model* model;
+	bool namedLevels;
+	vector<int> factorBegin;
+	int lineNumber;
+	string error;
+};
+
+//the state of a binary suite file being read a chunk at a time
+struct BinarySuiteSource
+{
+	MappedSuite suite;
+	long long nextRow;
+	string error;
+};
+
+/**
+ *
+ *	This function reads rows of a text suite file, in the
+ *  layout of testsuite.txt (component numbers) or of a
+ *  model's suite file (level names). The count on the
+ *  first line and blank lines are skipped. Each row is
+ *  turned into level indices.
+ *
+ *	Returns the rows read, 0 at the end of the file or -1 on an error.
+ *
+ */
+static int readTextRows(int* cells, int maxRows, void* sourceData)
+{
+	TextSuiteSource& source = *(TextSuiteSource*)sourceData;
+	Model& model = *source.model;
+	int factors = model.levels.size();
+	int rows = 0;
+	string line;
+	while (rows != maxRows && getline(source.input, line))
+	{
+		source.lineNumber++;
+		if (source.lineNumber == 1 || line.find_first_not_of(" \t\r") == string::npos)
+		{
+			continue;
+		}
+
+		//split the line in place, one field per factor
+		int* row = cells + (size_t)rows * factors;
+		int factor = 0;
+		const char* field = line.c_str();
+		while (true)
+		{
+			field += strspn(field, " \t\r");
+			size_t length = strcspn(field, " \t\r");
+			if (length == 0)
+			{
+				break;
+			}
+			if (factor == factors)
+			{
+				source.error = string("Line ") + to_string(source.lineNumber) + " of " + source.fileName + " has more than " + to_string(factors) + " factors.";
+				return -1;
+			}
+			int level = -1;
+			if (source.namedLevels)
+			{
+				const vector<string>& names = model.levelNames[factor];
+				for (int l = 0; l != names.size() && level < 0; l++)
+				{
+					if (names[l].size() == length && names[l].compare(0, length, field, length) == 0)
+					{
+						level = l;
+					}
+				}
+			}
+			else
+			{
+				char* end = NULL;
+				long component = strtol(field, &end, 10);
+				if (end == field + length)
+				{
+					level = component - source.factorBegin[factor];
+				}
+			}
+			if (level < 0 || level >= model.levels[factor])
+			{
+				source.error = string("\"") + string(field, length) + "\" on line " + to_string(source.lineNumber) + " of " + source.fileName + " is not a " + (source.namedLevels ? "level" : "component") + " of factor " + model.factorNames[factor] + ".";
+				return -1;
+			}
+			row[factor++] = level;
+			field += length;
+		}
+		if (factor != factors)
+		{
+			source.error = string("Line ") + to_string(source.lineNumber) + " of " + source.fileName + " has " + to_string(factor) + " factors instead of " + to_string(factors) + ".";
+			return -1;
+		}
+		rows++;
+	}
+	return rows;
+}
+
+/**
+ *
+ *	This function reads rows of a mapped binary suite file,
+ *  which already holds level indices.
+ *
+ *	Returns the rows read, 0 at the end of the file or -1 on an error.
+ *
+ */
+static int readBinaryRows(int* cells, int maxRows, void* sourceData)
+{
+	BinarySuiteSource& source = *(BinarySuiteSource*)sourceData;
+	const vector<int>& levels = source.suite.levels();
+	int factors = source.suite.factors();
+	int rows = 0;
+	for (; rows != maxRows && source.nextRow != source.suite.size(); rows++, source.nextRow++)
+	{
+		for (int f = 0; f != factors; f++)
+		{
+			//a 4-byte cell of 2^31 or more reads back negative
+			int level = source.suite.level(source.nextRow, f);
+			if (level < 0 || level >= levels[f])
+			{
+				source.error = string("Row ") + to_string(source.nextRow) + " of the suite file has level " + to_string(level) + " for a factor with " + to_string(levels[f]) + " levels.";
+				return -1;
+			}
+			cells[(size_t)rows * factors + f] = level;
+		}
+	}
+	return rows;
+}
+
+/**
+ *
+ *	This function marks every t-way tuple of a row (level
+ *  indices) as covered, and counts it if counts is given.
+ *  The first t-1 factors of a tuple are walked in
+ *  lexicographic order, and for each such prefix its rank
+ *  and mixed-radix value are worked out once, so each
+ *  choice of the last factor only costs a lookup of its
+ *  block and a multiply.
+ *
+ *	Returns no value(s).
+ *
+ */
+static void markRowTuples(const int* row, const int* levels, int factors, const TupleCoverage& coverage, uint64_t* covered, uint32_t* counts)
+{
+	int strength = coverage.getStrength();
+	int prefixLength = strength - 1;
+	int prefix[maxStrength];
+	for (int i = 0; i != prefixLength; i++)
+	{
+		prefix[i] = i;
+	}
+
+	while (true)
+	{
+		uint64_t prefixRank = 0;
+		uint64_t prefixValue = 0;
+		for (int i = 0; i != prefixLength; i++)
+		{
+			prefixRank += coverage.chooseUnchecked(prefix[i], i + 1);
+			prefixValue = prefixValue * levels[prefix[i]] + row[prefix[i]];
+		}
+		for (int last = prefix[prefixLength - 1] + 1; last != factors; last++)
+		{
+			uint64_t index = coverage.subsetStart(prefixRank + coverage.chooseUnchecked(last, strength)) + prefixValue * levels[last] + row[last];
+			covered[index >> 6] |= (uint64_t)1 << (index & 63);
+			if (counts != NULL)
+			{
+				__atomic_fetch_add(&counts[index], 1, __ATOMIC_RELAXED);
+			}
+		}
+
+		//advance to the next prefix that still leaves room for a last factor
+		int i = prefixLength - 1;
+		while (i >= 0 && prefix[i] == factors - 1 - prefixLength + i)
+		{
+			i--;
+		}
+		if (i < 0)
+		{
+			return;
+		}
+		prefix[i]++;
+		for (int j = i + 1; j != prefixLength; j++)
+		{
+			prefix[j] = prefix[j - 1] + 1;
+		}
+	}
+}
+
+/**
+ *
+ *	This function checks the t-way coverage of a suite read
+ *  from a row source a chunk at a time, so a suite of any
+ *  length is checked in the memory of one chunk plus one
+ *  bit per tuple per thread. Tuples the constraints rule
+ *  out do not need covering.
+ *
+ *  Each chunk is cut into slices that run in parallel.
+ *  Every thread marks the tuples of its rows in its own
+ *  bitset, and after the chunk the bitsets are merged into
+ *  the report's coverage, which gives the point of the
+ *  growth curve for the rows read so far. The first chunks
+ *  hold 1, 1, 2, 4, ... rows so the start of the curve,
+ *  where coverage grows fastest, is seen in detail. With
+ *  countTuples, the rows covering each tuple are counted
+ *  as well (with atomic adds, since slices share tuples).
+ *  Rows that break a constraint are counted.
+ *
+ *	Returns false if the source reported an error, or if the
+ *  model has fewer factors than the strength (no row is read).
+ *
+ */
+bool verifyRows(RowSource source, void* sourceData, vector<int>& levels, int strength, ConstraintSet& constraints, ThreadPool& pool, bool countTuples, CoverageReport& report)
+{
+	//a tuple needs strength factors, and the tuple walk would run past the row without them
+	if (levels.size() < strength)
+	{
+		return false;
+	}
+	int factors = levels.size();
+	vector<int> factorBegin = factorStartingNums(levels);
+	TupleCoverage& coverage = report.coverage;
+	coverage.reset(levels, strength);
+	if (!constraints.empty())
+	{
+		vector<int> startingCounts = initializeUncoveredTuples(levels, strength);
+		excludeForbiddenTuples(coverage, startingCounts, factorBegin, constraints);
+	}
+	report.rows = 0;
+	report.required = coverage.uncoveredCount();
+	report.forbidden = coverage.tupleCount() - report.required;
+	report.invalidRows = 0;
+	report.growth.clear();
+	report.counts.assign(countTuples ? coverage.tupleCount() : 0, 0);
+
+	//one bitset (set means covered) and one invalid row count per thread
+	vector<vector<uint64_t>> slotCovered(pool.slots(), vector<uint64_t>((coverage.tupleCount() + 63) / 64, 0));
+	vector<long long> slotInvalid(pool.slots(), 0);
+	vector<TestCase> slotCase(pool.slots(), TestCase(factors));
+	vector<int> cells((size_t)chunkRows * factors);
+	uint32_t* counts = report.counts.data();
+
+	for (int wanted = 1; true; wanted = min<long long>(report.rows, chunkRows))
+	{
+		int rows = source(cells.data(), wanted, sourceData);
+		if (rows < 0)
+		{
+			return false;
+		}
+		if (rows == 0)
+		{
+			break;
+		}
+
+		int slices = min(rows, pool.slots() * slicesPerThread);
+		pool.parallelFor(slices, [&](int slice)
+		{
+			int slot = ThreadPool::currentSlot();
+			uint64_t* covered = slotCovered[slot].data();
+			int last = (long long)rows * (slice + 1) / slices;
+			for (int r = (long long)rows * slice / slices; r != last; r++)
+			{
+				const int* row = &cells[(size_t)r * factors];
+				markRowTuples(row, levels.data(), factors, coverage, covered, countTuples ? counts : NULL);
+
+				if (!constraints.empty())
+				{
+					TestCase& testCase = slotCase[slot];
+					for (int f = 0; f != factors; f++)
+					{
+						testCase.setComponent(f, factorBegin[f] + row[f]);
+					}
+					slotInvalid[slot] += !constraints.allowsTestCase(testCase);
+				}
+			}
+		});
+
+		//merge every thread's bitset into the coverage for this point of the growth curve
+		for (int s = 0; s != pool.slots(); s++)
+		{
+			coverage.coverBits(slotCovered[s]);
+		}
+		report.rows += rows;
+		report.growth.push_back(make_pair(report.rows, report.required - coverage.uncoveredCount()));
+	}
+
+	report.covered = report.required - coverage.uncoveredCount();
+	for (int s = 0; s != pool.slots(); s++)
+	{
+		report.invalidRows += slotInvalid[s];
+	}
+	return true;
+}
+
+/**
+ *
+ *	This function checks the coverage of a suite file
+ *  against a model. A binary suite file is read through
+ *  its mapping and must have been written for the model's
+ *  levels. A text file holds level names when namedLevels
+ *  is set (a model's suite file) and component numbers
+ *  otherwise (testsuite.txt).
+ *
+ *	Returns true if the suite was read without errors, otherwise
+ *  sets error to the first error found and returns false.
+ *
+ */
+bool verifySuiteFile(const string& fileName, Model& model, bool namedLevels, ThreadPool& pool, bool countTuples, CoverageReport& report, string& error)
+{
+	if (model.levels.size() < model.strength)
+	{
+		error = "The model needs at least " + to_string(model.strength) + " factors for strength " + to_string(model.strength) + ".";
+		return false;
+	}
+	if (isSuiteFile(fileName))
+	{
+		BinarySuiteSource source;
+		source.nextRow = 0;
+		if (!source.suite.open(fileName, error))
+		{
+			return false;
+		}
+		if (source.suite.levels() != model.levels)
+		{
+			error = fileName + " was written for a model with different factors or levels.";
+			return false;
+		}
+		if (!verifyRows(readBinaryRows, &source, model.levels, model.strength, model.constraints, pool, countTuples, report))
+		{
+			error = source.error;
+			return false;
+		}
+		return true;
+	}
+
+	TextSuiteSource source;
+	source.input.open(fileName.c_str());
+	if (!source.input)
+	{
+		error = string("Could not open suite file ") + fileName + ".";
+		return false;
+	}
+	source.fileName = fileName;
+	source.model = &model;
+	source.namedLevels = namedLevels;
+	source.factorBegin = factorStartingNums(model.levels);
+	source.lineNumber = 0;
+	if (!verifyRows(readTextRows, &source, model.levels, model.strength, model.constraints, pool, countTuples, report))
+	{
+		error = source.error;
+		return false;
+	}
+	return true;
+}
+
+/**
+ *
+ *	This function writes one tuple as Factor=Level entries
+ *  separated by spaces.
+ *
+ *	Returns the tuple as text.
+ *
+ */
+static string tupleText(const CoverageReport& report, Model& model, uint64_t index)
+{
+	int tupleFactors[maxStrength];
+	int tupleLevels[maxStrength];
+	report.coverage.decodeTuple(index, tupleFactors, tupleLevels);
+	string text;
+	for (int i = 0; i != report.coverage.getStrength(); i++)
+	{
+		text += (i == 0 ? "" : " ") + model.factorNames[tupleFactors[i]] + "=" + model.levelNames[tupleFactors[i]][tupleLevels[i]];
+	}
+	return text;
+}
+
+/**
+ *
+ *	This function prints a coverage report to the console:
+ *  the tuples covered and missing, the first missing
+ *  tuples, the growth curve and, if the tuples were
+ *  counted, how many tuples are covered by 1, 2, 3-4, 5-8,
+ *  ... rows. Given a file name, every missing tuple is
+ *  written to it, or with counts every tuple that needs
+ *  covering with the number of rows covering it, one
+ *  tuple per line.
+ *
+ *	Returns false if the report file could not be written.
+ *
+ */
+bool outputCoverageReport(CoverageReport& report, Model& model, const string& reportFile)
+{
+	const TupleCoverage& coverage = report.coverage;
+	uint64_t missing = report.required - report.covered;
+	cout << "********** Coverage **********" << endl;
+	cout << "Rows: " << report.rows << endl;
+	cout << "Strength: " << coverage.getStrength() << endl;
+	cout << "Tuples to cover: " << report.required << endl;
+	if (report.forbidden != 0)
+	{
+		cout << "Tuples excluded by the constraints: " << report.forbidden << endl;
+	}
+	cout << "Tuples covered: " << report.covered << " (" << (report.required == 0 ? 100.0 : 100.0 * report.covered / report.required) << "%)" << endl;
+	cout << "Tuples missing: " << missing << endl;
+	if (report.invalidRows != 0)
+	{
+		cout << "Rows breaking a constraint: " << report.invalidRows << endl;
+	}
+
+	//the first missing tuples, in index order
+	uint64_t index = coverage.nextUncovered(0);
+	for (int listed = 0; listed != listedTuples && index != coverage.tupleCount(); listed++)
+	{
+		cout << "  missing: " << tupleText(report, model, index) << endl;
+		index = coverage.nextUncovered(index + 1);
+	}
+	if (missing > listedTuples)
+	{
+		cout << "  ... and " << missing - listedTuples << " more" << endl;
+	}
+
+	cout << "Coverage growth (rows: tuples covered):" << endl;
+	for (int i = 0; i != report.growth.size(); i++)
+	{
+		cout << "  " << report.growth[i].first << ": " << report.growth[i].second << endl;
+	}
+
+	//bucket the counts of the tuples that need covering by powers of two
+	if (!report.counts.empty())
+	{
+		vector<uint64_t> buckets;
+		for (uint64_t t = 0; t != report.counts.size(); t++)
+		{
+			uint32_t count = report.counts[t];
+			if (count == 0)
+			{
+				continue;
+			}
+			int bucket = 0;
+			while (((uint64_t)1 << bucket) < count)
+			{
+				bucket++;
+			}
+			if (bucket >= buckets.size())
+			{
+				buckets.resize(bucket + 1, 0);
+			}
+			buckets[bucket]++;
+		}
+		cout << "Tuples by the number of rows covering them:" << endl;
+		for (int b = 0; b != buckets.size(); b++)
+		{
+			if (buckets[b] != 0)
+			{
+				long long low = b < 2 ? b + 1 : ((long long)1 << (b - 1)) + 1;
+				cout << "  " << low;
+				if (low != (1LL << b))
+				{
+					cout << "-" << (1LL << b);
+				}
+				cout << (b == 0 ? " row: " : " rows: ") << buckets[b] << endl;
+			}
+		}
+	}
+
+	if (reportFile.empty())
+	{
+		return true;
+	}
+	ofstream output(reportFile.c_str());
+	if (!output)
+	{
+		return false;
+	}
+	if (report.counts.empty())
+	{
+		for (index = coverage.nextUncovered(0); index != coverage.tupleCount(); index = coverage.nextUncovered(index + 1))
+		{
+			output << "0 " << tupleText(report, model, index) << "\n";
+		}
+	}
+	else
+	{
+		//tuples with no covering row are either missing or excluded by the constraints
+		for (index = 0; index != coverage.tupleCount(); index++)
+		{
+			if (report.counts[index] != 0 || coverage.isUncovered(index))
+			{
+				output << report.counts[index] << " " << tupleText(report, model, index) << "\n";
+			}
+		}
+	}
+	return true;
+}
\ No newline at end of file